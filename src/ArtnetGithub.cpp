@@ -24,7 +24,8 @@ THE SOFTWARE.
 
 #include "ArtnetGithub.h"
 
-Artnet::Artnet() {}
+#if defined(ARDUINO)
+Artnet::Artnet() : transport(&defaultTransport) {}
 
 void Artnet::begin(byte mac[], byte ip[])
 {
@@ -32,20 +33,30 @@ void Artnet::begin(byte mac[], byte ip[])
   Ethernet.begin(mac, ip);
 #endif
 
-  Udp.begin(ART_NET_PORT);
+  transport->begin(ART_NET_PORT);
+}
+#else
+// No default network stack off-target, setTransport() is mandatory
+Artnet::Artnet() : transport(nullptr) {}
+#endif
+
+void Artnet::setTransport(ArtnetTransport *t)
+{
+  transport = t;
 }
 
 void Artnet::begin()
 {
-  Udp.begin(ART_NET_PORT);
+  transport->begin(ART_NET_PORT);
 }
 
 void Artnet::beginCustomArtPoll(int startU, int nbU)
 {
-  Udp.begin(ART_NET_PORT);
+  transport->begin(ART_NET_PORT);
   customArtPollReply = true;
   startUniverse = startU;
   nbUniverses = nbU;
+  buildPollReplies();
 }
 
 void Artnet::setBroadcastAuto(IPAddress ip, IPAddress sn)
@@ -107,18 +118,24 @@ void Artnet::modifyArtpollReply(String shortname, String longname, int port, int
 
 uint16_t Artnet::read()
 {
-  packetSize = Udp.parsePacket();
+  if (customArtPollReply)
+    sendPendingPollReply();
+
+  packetSize = transport->parsePacket();
 
-  remoteIP = Udp.remoteIP();
+  remoteIP = transport->remoteIP();
   if (packetSize <= MAX_BUFFER_ARTNET && packetSize > 0)
   {
-    Udp.read(artnetPacket, MAX_BUFFER_ARTNET);
+    transport->read(artnetPacket, MAX_BUFFER_ARTNET);
 
     // Check that packetID is "Art-Net" else ignore
     for (byte i = 0; i < 8; i++)
     {
       if (artnetPacket[i] != ART_NET_ID[i])
+      {
+        rejectedPackets++;
         return 0;
+      }
     }
 
     opcode = artnetPacket[8] | artnetPacket[9] << 8;
@@ -126,7 +143,8 @@ uint16_t Artnet::read()
     if (opcode == ART_DMX)
     {
       sequence = artnetPacket[12];
-      incomingUniverse = artnetPacket[14] | artnetPacket[15] << 8;
+      // SubUni then Net : together the 15 bits Port-Address
+      incomingUniverse = (artnetPacket[14] | artnetPacket[15] << 8) & ART_PORT_ADDRESS_MASK;
       dmxDataLength = artnetPacket[17] | artnetPacket[16] << 8;
 
       if (artDmxCallback)
@@ -156,6 +174,9 @@ uint16_t Artnet::read()
   }
   else
   {
+    // too big to be Art-Net
+    if (packetSize > 0)
+      rejectedPackets++;
     return 0;
   }
   return 0;
@@ -169,11 +190,7 @@ void Artnet::standardArtPoll()
   Serial.print(" broadcast addr: ");
   Serial.println(broadcast);
 
-#if !defined(ARDUINO_SAMD_ZERO) && !defined(ESP8266) && !defined(ESP32)
-  IPAddress local_ip = Ethernet.localIP();
-#else
-  IPAddress local_ip = WiFi.localIP();
-#endif
+  IPAddress local_ip = transport->localIP();
   node_ip_address[0] = local_ip[0];
   node_ip_address[1] = local_ip[1];
   node_ip_address[2] = local_ip[2];
@@ -230,106 +247,145 @@ void Artnet::standardArtPoll()
   }
 
   sprintf((char *)ArtPollReply.nodereport, "%i DMX output universes active.", ArtPollReply.numbports);
-  Udp.beginPacket(broadcast, ART_NET_PORT); // send the packet to the broadcast address
-  Udp.write((uint8_t *)&ArtPollReply, sizeof(ArtPollReply));
-  Udp.endPacket();
+  transport->beginPacket(broadcast, ART_NET_PORT); // send the packet to the broadcast address
+  transport->write((uint8_t *)&ArtPollReply, sizeof(ArtPollReply));
+  transport->endPacket();
 }
 
-void Artnet::customArtPoll()
+void Artnet::buildPollReplies()
 {
-  int nbArtPoll = nbUniverses / 4 + ((nbUniverses %4 )? 1 : 0 );     // +1 seulement si le reste de la division entiere est différent de 0
-
-  for (int i = 0; i < nbArtPoll; i++)
+  // Every field is computed once here, customArtPoll only sends the pages.
+  // The 4 ports of a page share the Net and Sub-Net of the reply : a page ends
+  // after 4 universes or when the next one is in another group of 16
+  nbPollReplies = 0;
+  int ports = 4;
+  for (int u = startUniverse; u < startUniverse + nbUniverses; u++)
+  {
+    if (ports == 4 || ART_UNIVERSE_OF(u) == 0)
+    {
+      nbPollReplies++;
+      ports = 0;
+    }
+    ports++;
+  }
+  free(pollReplies);
+  pollReplies = (struct artnet_reply_s *)calloc(nbPollReplies, sizeof(struct artnet_reply_s));
+  nextPollReply = nbPollReplies;
+
+  pollReplyIP = transport->localIP();
+  node_ip_address[0] = pollReplyIP[0];
+  node_ip_address[1] = pollReplyIP[1];
+  node_ip_address[2] = pollReplyIP[2];
+  node_ip_address[3] = pollReplyIP[3];
+
+  int universe = startUniverse;
+  int last = startUniverse + nbUniverses;
+  for (int i = 0; i < nbPollReplies; i++)
   {
-    // fill the reply struct, and then send it to the network's broadcast address
-    Serial.print("POLL nb ");
-    Serial.print(i);
-    Serial.print(" from ");
-    Serial.print(remoteIP);
-    Serial.print(" broadcast addr: ");
-    Serial.println(broadcast);
+    struct artnet_reply_s &reply = pollReplies[i];
 
-#if !defined(ARDUINO_SAMD_ZERO) && !defined(ESP8266) && !defined(ESP32)
-    IPAddress local_ip = Ethernet.localIP();
-#else
-    IPAddress local_ip = WiFi.localIP();
-#endif
-    node_ip_address[0] = local_ip[0];
-    node_ip_address[1] = local_ip[1];
-    node_ip_address[2] = local_ip[2];
-    node_ip_address[3] = local_ip[3];
+    // Universes of this page
+    int first = universe;
+    while (universe < last && universe - first < 4 && (universe == first || ART_UNIVERSE_OF(universe) != 0))
+      universe++;
+    int nbPorts = universe - first;
 
-    sprintf((char *)id, "Art-Net");
-    memcpy(ArtPollReply.id, id, sizeof(ArtPollReply.id));
-    memcpy(ArtPollReply.ip, node_ip_address, sizeof(ArtPollReply.ip));
+    memcpy(reply.id, ART_NET_ID, sizeof(reply.id));
+    memcpy(reply.ip, node_ip_address, sizeof(reply.ip));
 
-    ArtPollReply.opCode = ART_POLL_REPLY;
-    ArtPollReply.port = ART_NET_PORT;
+    reply.opCode = ART_POLL_REPLY;
+    reply.port = ART_NET_PORT;
 
-    memset(ArtPollReply.goodinput, 0x08, 4);
-    memset(ArtPollReply.goodoutput, 0x80, 4);
-    memset(ArtPollReply.porttypes, 0xc0, 4);
+    memset(reply.goodinput, 0x08, nbPorts);
+    memset(reply.goodoutput, 0x80, nbPorts);
+    memset(reply.porttypes, 0xc0, nbPorts);
 
-    uint8_t shortname[18];
-    uint8_t longname[64];
     // change shortname to Teensy artnet + i
     //  in order to have artnet1, arntet2, artnet3, artnet4
-    sprintf((char *)shortname, "artnet arduino %i", i);
-
-    sprintf((char *)longname, "Art-Net -> Arduino Bridge");
-    memcpy(ArtPollReply.shortname, shortname, sizeof(shortname));
-    memcpy(ArtPollReply.longname, longname, sizeof(longname));
-
-    ArtPollReply.etsaman[0] = 0;
-    ArtPollReply.etsaman[1] = 0;
-    ArtPollReply.verH = 1;
-    ArtPollReply.ver = 0;
-    ArtPollReply.subH = 0;
-    ArtPollReply.sub = 0;
-    ArtPollReply.oemH = 0;
-    ArtPollReply.oem = 0xFF;
-    ArtPollReply.ubea = 0;
-    ArtPollReply.status = 0xd2;
-    ArtPollReply.swvideo = 0;
-    ArtPollReply.swmacro = 0;
-    ArtPollReply.swremote = 0;
-    ArtPollReply.style = 0;
-
-    ArtPollReply.numbportsH = 0;
-    ArtPollReply.numbports = 4;
-    ArtPollReply.status2 = 0x08;
-
-    ArtPollReply.bindip[0] = node_ip_address[0];
-    ArtPollReply.bindip[1] = node_ip_address[1];
-    ArtPollReply.bindip[2] = node_ip_address[2];
-    ArtPollReply.bindip[3] = node_ip_address[3];
-
-    /*
-    uint8_t swin[4] = {0x07, 0x08, 0x09, 0x0A};
-      uint8_t swout[4] = {0x07, 0x08, 0x09, 0x0A};
-      for (uint8_t i = 0; i < 4; i++)
-      {
-        ArtPollReply.swout[i] = swout[i];
-        ArtPollReply.swin[i] = swin[i];
-      }
-    */
+    snprintf((char *)reply.shortname, sizeof(reply.shortname), "artnet %i", i);
+    snprintf((char *)reply.longname, sizeof(reply.longname), "Art-Net -> Arduino Bridge");
+
+    reply.etsaman[0] = 0;
+    reply.etsaman[1] = 0;
+    reply.verH = 1;
+    reply.ver = 0;
+    // NetSwitch and SubSwitch, the high bits of the Port-Address of the 4 ports
+    reply.subH = ART_NET_OF(first);
+    reply.sub = ART_SUBNET_OF(first);
+    reply.oemH = 0;
+    reply.oem = 0xFF;
+    reply.ubea = 0;
+    reply.status = 0xd2;
+    reply.swvideo = 0;
+    reply.swmacro = 0;
+    reply.swremote = 0;
+    reply.style = 0;
+
+    reply.numbportsH = 0;
+    reply.numbports = nbPorts;
+    reply.status2 = 0x08;
+    // bindindex numbers the pages of a node, starting at 1
+    reply.bindindex = i + 1;
+
+    memcpy(reply.bindip, node_ip_address, sizeof(reply.bindip));
+
+    // swout[j] : low nibble of the Port-Address, to match the main for loop, and start universe
+    for (int j = 0; j < nbPorts; j++)
+    {
+      reply.swout[j] = ART_UNIVERSE_OF(first + j);
+      reply.swin[j] = ART_UNIVERSE_OF(first + j);
+    }
+
+    snprintf((char *)reply.nodereport, sizeof(reply.nodereport), "%i DMX output universes active.", reply.numbports);
+  }
+}
 
-    // change this for loop, to match the main for loop, and start universe
-    // swout[j] = startUniverse + i*4 + j;
-    // swin[j] = startUniverse + i*4 + j;
+void Artnet::setNodeReport(const char *report)
+{
+  for (int i = 0; i < nbPollReplies; i++)
+  {
+    strncpy((char *)pollReplies[i].nodereport, report, sizeof(pollReplies[i].nodereport) - 1);
+  }
+}
 
-    for (int j = 0; j < 4; j++)
+void Artnet::customArtPoll()
+{
+  // The address may have changed since the pages were built (DHCP lease)
+  IPAddress local_ip = transport->localIP();
+  if (local_ip != pollReplyIP)
+  {
+    pollReplyIP = local_ip;
+    for (int i = 0; i < nbPollReplies; i++)
     {
-      ArtPollReply.swout[j] = (uint8_t)(startUniverse + i * 4 + j);
-      ArtPollReply.swin[j] = (uint8_t)startUniverse + i * 4 + j;
+      for (int k = 0; k < 4; k++)
+      {
+        pollReplies[i].ip[k] = local_ip[k];
+        pollReplies[i].bindip[k] = local_ip[k];
+      }
     }
-
-    sprintf((char *)ArtPollReply.nodereport, "%i DMX output universes active.", ArtPollReply.numbports);
-    Udp.beginPacket(broadcast, ART_NET_PORT); // send the packet to the broadcast address
-    Udp.write((uint8_t *)&ArtPollReply, sizeof(ArtPollReply));
-    Udp.endPacket();
-    delay(10);
   }
+
+  // Pages are sent by sendPendingPollReply() from the following read() calls,
+  // a poll never blocks the DMX reception
+  nextPollReply = 0;
+  sendPendingPollReply();
+}
+
+void Artnet::sendPendingPollReply()
+{
+  if (nextPollReply >= nbPollReplies)
+    return;
+
+  // Leave some room between pages so the Ethernet TX buffers never fill up
+  unsigned long now = micros();
+  if (nextPollReply > 0 && now - lastPollReplyMicros < ART_POLL_REPLY_INTERVAL_US)
+    return;
+  lastPollReplyMicros = now;
+
+  transport->beginPacket(broadcast, ART_NET_PORT); // send the packet to the broadcast address
+  transport->write((uint8_t *)&pollReplies[nextPollReply], sizeof(struct artnet_reply_s));
+  transport->endPacket();
+  nextPollReply++;
 }
 
 void Artnet::printPacketHeader()
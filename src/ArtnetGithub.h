@@ -26,20 +26,7 @@ THE SOFTWARE.
 #define ARTNET_H
 
 #include <Arduino.h>
-
-#if defined(ARDUINO_SAMD_ZERO)
-#include <WiFi101.h>
-#include <WiFiUdp.h>
-#elif defined(ESP8266)
-#include <ESP8266WiFi.h>
-#include <WiFiUdp.h>
-#elif defined(ESP32)
-#include <WiFi.h>
-#include <WiFiUdp.h>
-#else
-#include <NativeEthernet.h>
-#include <NativeEthernetUdp.h>
-#endif
+#include "ArtnetTransport.h"
 
 // UDP specific
 #define ART_NET_PORT 6454
@@ -50,9 +37,19 @@ THE SOFTWARE.
 #define ART_SYNC 0x5200
 // Buffers
 #define MAX_BUFFER_ARTNET 530
+// Minimum time between two pages of a custom ArtPollReply
+#define ART_POLL_REPLY_INTERVAL_US 1000
+// Without ArtSync for this long a node goes back to immediate output (Art-Net 4 spec)
+#define ART_SYNC_TIMEOUT_MS 4000
 // Packet
 #define ART_NET_ID "Art-Net\0"
 #define ART_DMX_START 18
+// 15 bits Port-Address : Net (7 bits), Sub-Net (4 bits), Universe (4 bits)
+#define ART_PORT_ADDRESS_MASK 0x7FFF
+#define ART_PORT_ADDRESS(net, subnet, universe) ((((net) & 0x7F) << 8) | (((subnet) & 0x0F) << 4) | ((universe) & 0x0F))
+#define ART_NET_OF(address) (((address) >> 8) & 0x7F)
+#define ART_SUBNET_OF(address) (((address) >> 4) & 0x0F)
+#define ART_UNIVERSE_OF(address) ((address) & 0x0F)
 
 struct artnet_reply_s
 {
@@ -98,9 +95,13 @@ class Artnet
 public:
   Artnet();
 
+#if defined(ARDUINO)
   void begin(byte mac[], byte ip[]);
+#endif
   void begin();
-  void Artnet::beginCustomArtPoll(int startUniverse, int nbUniverses);
+  void beginCustomArtPoll(int startUniverse, int nbUniverses);
+  // Replace the network backend. Must be called before begin()
+  void setTransport(ArtnetTransport *t);
   void setBroadcastAuto(IPAddress ip, IPAddress sn);
   void setBroadcast(byte bc[]);
   void setBroadcast(IPAddress bc);
@@ -110,6 +111,8 @@ public:
   void modifyArtpollReply(String s, String l, int port, int *swin, int *swout);
   void standardArtPoll();
   void customArtPoll();
+  // Text of the nodereport field of the custom poll reply, 63 chars max
+  void setNodeReport(const char *report);
 
   // Return a pointer to the start of the DMX data
   inline uint8_t *getDmxFrame(String shortname, String longname, int port, int *swin, int *swout)
@@ -127,6 +130,7 @@ public:
     return sequence;
   }
 
+  // 15 bits Port-Address of the last ArtDmx, Net and Sub-Net included
   inline uint16_t getUniverse(void)
   {
     return incomingUniverse;
@@ -142,6 +146,12 @@ public:
     return remoteIP;
   }
 
+  // Packets dropped because they are not Art-Net or too big
+  inline uint32_t getRejectedPackets(void)
+  {
+    return rejectedPackets;
+  }
+
   inline void setArtDmxCallback(void (*fptr)(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP))
   {
     artDmxCallback = fptr;
@@ -158,12 +168,19 @@ private:
   bool customArtPollReply = false;
   int startUniverse;
   int nbUniverses;
-#if defined(ARDUINO_SAMD_ZERO) || defined(ESP8266) || defined(ESP32)
-  WiFiUDP Udp;
-#else
-  EthernetUDP Udp;
+#if defined(ARDUINO)
+  ArtnetUdpTransport defaultTransport;
 #endif
+  ArtnetTransport *transport;
   struct artnet_reply_s ArtPollReply;
+  // Custom poll reply, one prebuilt page per group of up to 4 universes with the same Net and Sub-Net
+  struct artnet_reply_s *pollReplies = nullptr;
+  int nbPollReplies = 0;
+  int nextPollReply = 0; // next page to send, nbPollReplies when idle
+  unsigned long lastPollReplyMicros = 0;
+  IPAddress pollReplyIP;
+  void buildPollReplies();
+  void sendPendingPollReply();
 
   uint8_t artnetPacket[MAX_BUFFER_ARTNET];
   uint16_t packetSize;
@@ -173,8 +190,9 @@ private:
   uint16_t incomingUniverse;
   uint16_t dmxDataLength;
   IPAddress remoteIP;
-  void (*artDmxCallback)(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP);
-  void (*artSyncCallback)(IPAddress remoteIP);
+  uint32_t rejectedPackets = 0;
+  void (*artDmxCallback)(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP) = nullptr;
+  void (*artSyncCallback)(IPAddress remoteIP) = nullptr;
 };
 
 #endif
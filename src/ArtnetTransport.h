@@ -0,0 +1,105 @@
+/*
+ * @brief Network abstraction used by the Artnet class
+ *
+ * @details Artnet (and the E131 receiver) only need a handful of UDP
+ * primitives. They are grouped here so the same receive path can run on the
+ * Teensy (NativeEthernet), on WiFi boards, or on a workstation (see
+ * host/PosixUdpTransport.h).
+ *
+ */
+
+#ifndef ARTNET_TRANSPORT_H
+#define ARTNET_TRANSPORT_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO)
+#if defined(ARDUINO_SAMD_ZERO)
+#include <WiFi101.h>
+#include <WiFiUdp.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#elif defined(ESP32)
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#else
+#include <NativeEthernet.h>
+#include <NativeEthernetUdp.h>
+#endif
+#endif
+
+class ArtnetTransport
+{
+public:
+  virtual ~ArtnetTransport() {}
+
+  // Open the socket on the given local port. Return 1 on success
+  virtual uint8_t begin(uint16_t port) = 0;
+  // Fetch the next datagram, return its size or 0 if nothing is pending
+  virtual int parsePacket() = 0;
+  // Copy the current datagram into buffer, return the number of bytes copied
+  virtual int read(uint8_t *buffer, size_t len) = 0;
+  virtual IPAddress remoteIP() = 0;
+  virtual IPAddress localIP() = 0;
+  virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+  virtual int endPacket() = 0;
+  // Also receive the datagrams sent to a multicast group, on the port given to begin().
+  // Return 0 when the group could not be joined
+  virtual uint8_t joinMulticast(IPAddress group)
+  {
+    return 0;
+  }
+};
+
+#if defined(ARDUINO)
+// Default transport : the board UDP stack
+class ArtnetUdpTransport : public ArtnetTransport
+{
+public:
+  uint8_t begin(uint16_t port)
+  {
+    localPort = port;
+    return Udp.begin(port);
+  }
+  int parsePacket() { return Udp.parsePacket(); }
+  int read(uint8_t *buffer, size_t len) { return Udp.read(buffer, len); }
+  IPAddress remoteIP() { return Udp.remoteIP(); }
+  int beginPacket(IPAddress ip, uint16_t port) { return Udp.beginPacket(ip, port); }
+  size_t write(const uint8_t *buffer, size_t size) { return Udp.write(buffer, size); }
+  int endPacket() { return Udp.endPacket(); }
+
+#if !defined(ARDUINO_SAMD_ZERO) && !defined(ESP8266) && !defined(ESP32)
+  // The Arduino UDP API listens to a single group per socket : the first
+  // join rebinds the socket on it, the next ones are refused
+  uint8_t joinMulticast(IPAddress group)
+  {
+    if (joined)
+      return 0;
+    joined = true;
+    return Udp.beginMulticast(group, localPort);
+  }
+#endif
+
+  IPAddress localIP()
+  {
+#if defined(ARDUINO_SAMD_ZERO) || defined(ESP8266) || defined(ESP32)
+    return WiFi.localIP();
+#else
+    return Ethernet.localIP();
+#endif
+  }
+
+private:
+  uint16_t localPort = 0;
+  bool joined = false;
+#if defined(ARDUINO_SAMD_ZERO) || defined(ESP8266) || defined(ESP32)
+  WiFiUDP Udp;
+#else
+  EthernetUDP Udp;
+#endif
+};
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * @brief Timestamped list of the boot steps
+ */
+
+#include "BootTimeline.h"
+
+BootTimeline::BootTimeline() : count(0) {}
+
+void BootTimeline::mark(const char *step)
+{
+  // a retry : the last one is timed, the count keeps the others
+  if (count > 0 && steps[count - 1] == step)
+  {
+    times[count - 1] = millis();
+    repeats[count - 1]++;
+    printStep(count - 1);
+    return;
+  }
+  if (count >= BOOT_TIMELINE_STEPS)
+    return;
+  steps[count] = step;
+  times[count] = millis();
+  repeats[count] = 1;
+  printStep(count);
+  count++;
+}
+
+void BootTimeline::print()
+{
+  Serial.println("Boot timeline:");
+  for (int i = 0; i < count; i++)
+    printStep(i);
+}
+
+void BootTimeline::printStep(int index)
+{
+  char line[16];
+  snprintf(line, sizeof(line), "[%6lu ms] ", times[index]);
+  Serial.print(line);
+  Serial.print(steps[index]);
+  if (repeats[index] > 1)
+  {
+    Serial.print(" (x");
+    Serial.print(repeats[index]);
+    Serial.print(")");
+  }
+  Serial.println();
+}
@@ -0,0 +1,36 @@
+/*
+ * @brief Timestamped list of the boot steps
+ *
+ * @details Each step is printed as it happens and kept, so the timeline can
+ * be printed again once a serial monitor is attached ('b' command).
+ * The same step marked again in a row (a retry) updates its line and
+ * counts, it does not take a new one.
+ *
+ */
+
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+
+#define BOOT_TIMELINE_STEPS 24
+
+class BootTimeline
+{
+public:
+  BootTimeline();
+
+  // step must be a string literal, only the pointer is kept
+  void mark(const char *step);
+  void print();
+
+private:
+  const char *steps[BOOT_TIMELINE_STEPS];
+  unsigned long times[BOOT_TIMELINE_STEPS];
+  uint16_t repeats[BOOT_TIMELINE_STEPS]; // times the step was marked
+  int count;
+
+  void printStep(int index);
+};
+
+#endif
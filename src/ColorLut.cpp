@@ -0,0 +1,31 @@
+/*
+ * @brief Per channel gamma and white balance lookup tables
+ */
+
+#include "ColorLut.h"
+
+ColorLut::ColorLut()
+{
+  const float gamma[3] = {1.0f, 1.0f, 1.0f};
+  const uint8_t white[3] = {255, 255, 255};
+  build(gamma, white);
+}
+
+void ColorLut::build(const float gamma[3], const uint8_t white[3])
+{
+  identity = true;
+  for (int c = 0; c < 4; c++)
+  {
+    // the white leds follow the colors, there is no balance to apply to them
+    float g = c < 3 ? gamma[c] : (gamma[0] + gamma[1] + gamma[2]) / 3.0f;
+    float level = c < 3 ? white[c] : 255.0f;
+    for (int i = 0; i < 256; i++)
+    {
+      float value = level * powf(i / 255.0f, g);
+      table[c][i] = (uint8_t)(value + 0.5f);
+      table16[c][i] = (uint16_t)(value * 256.0f + 0.5f);
+      if (table[c][i] != i)
+        identity = false;
+    }
+  }
+}
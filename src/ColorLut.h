@@ -0,0 +1,29 @@
+/*
+ * @brief Per channel gamma and white balance lookup tables
+ *
+ * @details out = white * (in / 255) ^ gamma, one 256 entries table per
+ * color, plus one for the white leds of RGBW strips (mean gamma of the
+ * colors, full scale). The tables are applied by blitPixels while the
+ * universe is copied, there is no extra pass over the buffer. With gamma 1 and white 255 the
+ * tables are the identity and blitPixels keeps its plain copy path.
+ * table16 keeps the fractional part that the temporal dithering turns
+ * into extra resolution.
+ *
+ */
+
+#ifndef COLOR_LUT_H
+#define COLOR_LUT_H
+
+#include <Arduino.h>
+
+struct ColorLut
+{
+  uint8_t table[4][256];    // red, green, blue, white
+  uint16_t table16[4][256]; // same in 8.8 fixed point, for the dithering
+  bool identity;
+
+  ColorLut();
+  void build(const float gamma[3], const uint8_t white[3]);
+};
+
+#endif
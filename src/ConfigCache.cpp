@@ -0,0 +1,67 @@
+/*
+ * @brief Binary image of the parsed configuration, stored next to the JSON
+ */
+
+#include "ConfigCache.h"
+#include <SD.h>
+
+// Half byte table : 64 bytes instead of 1 KB, fast enough for a few KB at boot
+static const uint32_t crcNibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t crc32(const void *data, size_t size, uint32_t crc)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+  {
+    crc = crcNibble[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+    crc = crcNibble[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+bool readConfigCache(const char *path, void *config, uint32_t size, uint32_t buildId, uint32_t sourceCrc)
+{
+  File file = SD.open(path, FILE_READ);
+  if (!file)
+    return false;
+
+  // Header and struct in a single read
+  uint32_t total = sizeof(ConfigCacheHeader) + size;
+  uint8_t *image = (uint8_t *)malloc(total);
+  bool valid = image && file.size() == total && (uint32_t)file.read(image, total) == total;
+  file.close();
+
+  if (valid)
+  {
+    const ConfigCacheHeader *header = (const ConfigCacheHeader *)image;
+    const uint8_t *data = image + sizeof(ConfigCacheHeader);
+    valid = memcmp(header->magic, CONFIG_CACHE_MAGIC, 4) == 0 && header->buildId == buildId && header->size == size &&
+            header->sourceCrc == sourceCrc && header->dataCrc == crc32(data, size);
+    if (valid)
+      memcpy(config, data, size);
+  }
+  free(image);
+  return valid;
+}
+
+bool writeConfigCache(const char *path, const void *config, uint32_t size, uint32_t buildId, uint32_t sourceCrc)
+{
+  ConfigCacheHeader header;
+  memcpy(header.magic, CONFIG_CACHE_MAGIC, 4);
+  header.buildId = buildId;
+  header.size = size;
+  header.sourceCrc = sourceCrc;
+  header.dataCrc = crc32(config, size);
+
+  SD.remove(path);
+  File file = SD.open(path, FILE_WRITE_BEGIN);
+  if (!file)
+    return false;
+  bool ok = file.write(&header, sizeof(header)) == sizeof(header) && file.write(config, size) == size;
+  file.close();
+  return ok;
+}
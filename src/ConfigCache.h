@@ -0,0 +1,33 @@
+/*
+ * @brief Binary image of the parsed configuration, stored next to the JSON
+ *
+ * @details The image holds the configuration struct as the firmware uses
+ * it, with the CRC of the JSON it was made from, the id of the build that
+ * wrote it and the CRC of its own content. When all three still match the
+ * configuration is loaded with one read and the JSON is not parsed.
+ *
+ */
+
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <Arduino.h>
+
+#define CONFIG_CACHE_MAGIC "ACFG"
+
+struct ConfigCacheHeader
+{
+  char magic[4];
+  uint32_t buildId;   // changes with the firmware, the struct layout may have changed
+  uint32_t size;      // of the configuration struct
+  uint32_t sourceCrc; // of the JSON file
+  uint32_t dataCrc;   // of the configuration struct
+};
+
+// CRC-32 (IEEE 802.3). Pass the previous result to continue a computation
+uint32_t crc32(const void *data, size_t size, uint32_t crc = 0);
+// Return false when the image is missing, damaged or made from another JSON or build
+bool readConfigCache(const char *path, void *config, uint32_t size, uint32_t buildId, uint32_t sourceCrc);
+bool writeConfigCache(const char *path, const void *config, uint32_t size, uint32_t buildId, uint32_t sourceCrc);
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * @brief Temporal dithering of the last frame, for smooth fades near black
+ */
+
+#include "Dither.h"
+#include "PixelBlit.h"
+
+Dither::Dither() : source(nullptr), error(nullptr), numberOfStrips(0), ledsPerStrip(0), channels(3), scale(256), hasFrame(false), rendered(true) {}
+
+void Dither::begin(int strips, int leds, const uint8_t *o)
+{
+  numberOfStrips = min(strips, (int)sizeof(orders));
+  ledsPerStrip = leds;
+  memcpy(orders, o, numberOfStrips);
+  channels = pixelChannels(orders[0]);
+  free(source);
+  free(error);
+  source = (uint8_t *)calloc(numberOfStrips * leds * channels, 1);
+  error = (uint8_t *)calloc(numberOfStrips * leds * channels, 1);
+  scale = 256;
+  hasFrame = false;
+  rendered = true;
+}
+
+void Dither::render(uint8_t *drawing, const ColorLut *lut)
+{
+  const uint8_t *src = source;
+  uint8_t *err = error;
+
+  for (int s = 0; s < numberOfStrips; s++)
+  {
+    const uint8_t *colors = wireColor[orders[s] & PIXEL_ORDER_MASK];
+    const uint16_t *t0 = lut->table16[colors[0]];
+    const uint16_t *t1 = lut->table16[colors[1]];
+    const uint16_t *t2 = lut->table16[colors[2]];
+    const uint16_t *t3 = lut->table16[3];
+
+    for (int i = 0; i < ledsPerStrip; i++)
+    {
+      uint32_t a0 = ((t0[src[0]] * scale) >> 8) + err[0];
+      uint32_t a1 = ((t1[src[1]] * scale) >> 8) + err[1];
+      uint32_t a2 = ((t2[src[2]] * scale) >> 8) + err[2];
+      // table16 tops at 255 * 256, scale at 256, plus an error below 256 : never over 0xFFFF
+      drawing[0] = a0 >> 8;
+      drawing[1] = a1 >> 8;
+      drawing[2] = a2 >> 8;
+      err[0] = a0;
+      err[1] = a1;
+      err[2] = a2;
+      if (channels == 4)
+      {
+        uint32_t a3 = ((t3[src[3]] * scale) >> 8) + err[3];
+        drawing[3] = a3 >> 8;
+        err[3] = a3;
+      }
+      drawing += channels;
+      src += channels;
+      err += channels;
+    }
+  }
+  rendered = true;
+}
@@ -0,0 +1,72 @@
+/*
+ * @brief Temporal dithering of the last frame, for smooth fades near black
+ *
+ * @details The strips only take 8 bits per color but the gamma tables have
+ * 8 more bits of fraction (ColorLut::table16). Between two network frames
+ * the same frame is sent again as fast as the wire allows, each time with
+ * the fraction carried over in a per channel error accumulator (first
+ * order sigma delta), so the average light over a few refreshes has more
+ * than 8 bits of resolution.
+ *
+ */
+
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <Arduino.h>
+#include "ColorLut.h"
+
+class Dither
+{
+public:
+  Dither();
+
+  // One PixelOrder per strip, the tables follow the wire order of each strip.
+  // All the strips are RGB or all are RGBW (PIXEL_W)
+  void begin(int numberOfStrips, int ledsPerStrip, const uint8_t *orders);
+  // Write the next refresh of the current frame into drawing (wire order)
+  void render(uint8_t *drawing, const ColorLut *lut);
+
+  // Latest completed frame, raw DMX values in wire order. Call newFrame() once filled
+  inline uint8_t *getSource(void)
+  {
+    return source;
+  }
+
+  // Power limiter dimming, 256 = none. Applied after the gamma tables,
+  // dimming the DMX values before them would compound it by the gamma
+  inline void setScale(uint16_t s)
+  {
+    scale = s;
+  }
+
+  inline void newFrame(void)
+  {
+    hasFrame = true;
+    rendered = false;
+  }
+
+  inline bool isReady(void)
+  {
+    return hasFrame;
+  }
+
+  // False while the current frame has not been sent once
+  inline bool isRendered(void)
+  {
+    return rendered;
+  }
+
+private:
+  uint8_t *source;
+  uint8_t *error;
+  int numberOfStrips;
+  int ledsPerStrip;
+  int channels; // 3, 4 for RGBW
+  uint16_t scale;
+  uint8_t orders[8];
+  bool hasFrame;
+  bool rendered;
+};
+
+#endif
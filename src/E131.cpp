@@ -0,0 +1,217 @@
+/*
+ * @brief sACN (ANSI E1.31) receiver
+ */
+
+#include "E131.h"
+
+// Offsets in the packet, E1.31-2016 section 4
+#define E131_ROOT_VECTOR 18
+#define E131_CID 22
+#define E131_FRAMING_VECTOR 40
+#define E131_PRIORITY 108
+#define E131_SYNC_ADDRESS 109
+#define E131_SEQUENCE 111
+#define E131_OPTIONS 112
+#define E131_UNIVERSE 113
+#define E131_PROPERTY_COUNT 123
+#define E131_START_CODE 125
+#define E131_SYNC_SEQUENCE 44
+#define E131_SYNC_UNIVERSE 45
+#define E131_SYNC_LENGTH 49
+// Framing layer vectors
+#define E131_FRAMING_DATA 0x0002
+#define E131_FRAMING_SYNC 0x0001
+// Framing options
+#define E131_OPTION_PREVIEW 0x80
+#define E131_OPTION_TERMINATED 0x40
+
+static inline uint16_t read16(const uint8_t *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+static inline uint32_t read32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+#if defined(ARDUINO)
+E131::E131() : transport(&defaultTransport) {}
+#else
+// No default network stack off-target, setTransport() is mandatory
+E131::E131() : transport(nullptr) {}
+#endif
+
+void E131::setTransport(ArtnetTransport *t)
+{
+  transport = t;
+}
+
+void E131::begin(int startU, int nbU)
+{
+  startUniverse = startU;
+  nbUniverses = nbU;
+  free(sources);
+  sources = (UniverseSource *)calloc(nbU, sizeof(UniverseSource));
+  sequences.begin(nbU * E131_SOURCES, true);
+
+  transport->begin(E131_PORT);
+  // 239.255.UHi.ULo, unicast senders work even when a join is refused
+  for (int i = 0; i < nbU; i++)
+  {
+    int universe = startU + i;
+    transport->joinMulticast(IPAddress(239, 255, universe >> 8, universe & 0xFF));
+  }
+}
+
+uint16_t E131::read()
+{
+  packetSize = transport->parsePacket();
+  if (packetSize <= 0)
+    return 0;
+  if (packetSize > E131_MAX_PACKET || packetSize < E131_SYNC_LENGTH)
+  {
+    rejectedPackets++;
+    return 0;
+  }
+
+  remoteIP = transport->remoteIP();
+  transport->read(packet, E131_MAX_PACKET);
+
+  // Preamble size, postamble size, then the ACN packet identifier
+  if (read16(packet) != 0x0010 || read16(packet + 2) != 0 || memcmp(packet + 4, E131_ACN_ID, 12) != 0)
+  {
+    rejectedPackets++;
+    return 0;
+  }
+
+  switch (read32(packet + E131_ROOT_VECTOR))
+  {
+  case E131_DATA:
+    return readData();
+  case E131_SYNC:
+    return readSync();
+  }
+  rejectedPackets++;
+  return 0;
+}
+
+// Slot of the source with this CID on the universe, -1 when the other sources hold all of them
+int E131::sourceSlot(UniverseSource &source, const uint8_t *cid, unsigned long now)
+{
+  int freeSlot = -1;
+  for (int s = 0; s < E131_SOURCES; s++)
+  {
+    // Forget the sources that went silent, whoever is sending now
+    if (source.cidUsed[s] && now - source.cidMillis[s] > E131_PRIORITY_TIMEOUT_MS)
+      source.cidUsed[s] = false;
+  }
+  for (int s = 0; s < E131_SOURCES; s++)
+  {
+    if (source.cidUsed[s] && !memcmp(source.cid[s], cid, E131_CID_SIZE))
+    {
+      source.cidMillis[s] = now;
+      return s;
+    }
+    if (!source.cidUsed[s] && freeSlot < 0)
+      freeSlot = s;
+  }
+  if (freeSlot < 0)
+    return -1;
+  memcpy(source.cid[freeSlot], cid, E131_CID_SIZE);
+  source.cidMillis[freeSlot] = now;
+  source.cidUsed[freeSlot] = true;
+  // A new source starts its own sequence
+  sequences.restart((&source - sources) * E131_SOURCES + freeSlot);
+  return freeSlot;
+}
+
+uint16_t E131::readData()
+{
+  if (packetSize < E131_DMX_START || read32(packet + E131_FRAMING_VECTOR) != E131_FRAMING_DATA)
+  {
+    rejectedPackets++;
+    return 0;
+  }
+
+  uint8_t options = packet[E131_OPTIONS];
+  incomingUniverse = read16(packet + E131_UNIVERSE);
+  priority = packet[E131_PRIORITY];
+  sequence = packet[E131_SEQUENCE];
+  // The property count includes the start code
+  dmxDataLength = read16(packet + E131_PROPERTY_COUNT) - 1;
+  if (dmxDataLength > packetSize - E131_DMX_START)
+    dmxDataLength = packetSize - E131_DMX_START;
+
+  // Preview data is for visualisers, other start codes are not dimmer levels
+  if ((options & E131_OPTION_PREVIEW) || packet[E131_START_CODE] != 0)
+  {
+    rejectedPackets++;
+    return 0;
+  }
+
+  int index = incomingUniverse - startUniverse;
+  if (index < 0 || index >= nbUniverses)
+    return E131_DATA;
+
+  UniverseSource &source = sources[index];
+  unsigned long now = millis();
+  if (source.lastMillis && now - source.lastMillis > E131_PRIORITY_TIMEOUT_MS)
+    source.priority = 0;
+
+  if (options & E131_OPTION_TERMINATED)
+  {
+    // The source leaves : let any other one take the universe now
+    if (priority >= source.priority)
+      source.priority = 0;
+    return E131_DATA;
+  }
+
+  if (priority < source.priority)
+  {
+    lowPriorityPackets++;
+    return E131_DATA;
+  }
+  if (priority > source.priority)
+  {
+    // The sources of the old priority do not send this universe anymore
+    for (int s = 0; s < E131_SOURCES; s++)
+      source.cidUsed[s] = false;
+  }
+  source.priority = priority;
+  source.lastMillis = now;
+
+  int slot = sourceSlot(source, packet + E131_CID, now);
+  if (slot < 0)
+  {
+    lowPriorityPackets++;
+    return E131_DATA;
+  }
+
+  // A late packet belongs to an older frame : never let it overwrite newer pixels.
+  // Each source has its own sequence, two servers do not mark each other late
+  if (!sequences.accept(index * E131_SOURCES + slot, sequence))
+    return E131_DATA;
+
+  syncAddress = read16(packet + E131_SYNC_ADDRESS);
+  if (dmxCallback)
+    dmxCallback(incomingUniverse, dmxDataLength, 0, packet + E131_DMX_START, remoteIP);
+  return E131_DATA;
+}
+
+uint16_t E131::readSync()
+{
+  if (read32(packet + E131_FRAMING_VECTOR) != E131_FRAMING_SYNC)
+  {
+    rejectedPackets++;
+    return 0;
+  }
+
+  // Only the sync universe our data packets point to releases the frame
+  if (syncAddress && read16(packet + E131_SYNC_UNIVERSE) != syncAddress)
+    return E131_SYNC;
+
+  if (syncCallback)
+    syncCallback(remoteIP);
+  return E131_SYNC;
+}
@@ -0,0 +1,142 @@
+/*
+ * @brief sACN (ANSI E1.31) receiver
+ *
+ * @details Same shape as the Artnet class : read() fetches one datagram and
+ * calls the DMX or sync callback with a pointer into the receive buffer.
+ * Each universe keeps the highest priority source seen in the last
+ * E131_PRIORITY_TIMEOUT_MS, lower priority sources are ignored, and late
+ * packets are dropped with a SequenceTracker on the 0..255 ring. Up to
+ * E131_SOURCES sources of the same priority (main and backup servers) are
+ * told apart by their CID, each with its own sequence.
+ *
+ */
+
+#ifndef E131_H
+#define E131_H
+
+#include <Arduino.h>
+#include "ArtnetTransport.h"
+#include "SequenceTracker.h"
+
+// UDP specific
+#define E131_PORT 5568
+// Root layer vectors, returned by read()
+#define E131_DATA 0x0004
+#define E131_SYNC 0x0008
+// Buffers
+#define E131_MAX_PACKET 638
+// Packet
+#define E131_ACN_ID "ASC-E1.17\0\0\0"
+#define E131_DMX_START 126
+// A source that stops sending releases its priority after this delay
+#define E131_PRIORITY_TIMEOUT_MS 2500
+// Sources followed per universe, each with its own sequence
+#define E131_SOURCES 2
+#define E131_CID_SIZE 16
+
+class E131
+{
+public:
+  E131();
+
+  // Replace the network backend. Must be called before begin()
+  void setTransport(ArtnetTransport *t);
+  // Open the sACN port and join the multicast group of every universe
+  void begin(int startUniverse, int nbUniverses);
+  // Return E131_DATA or E131_SYNC when a packet has been handled, 0 otherwise
+  uint16_t read();
+
+  inline uint16_t getUniverse(void)
+  {
+    return incomingUniverse;
+  }
+
+  inline uint16_t getLength(void)
+  {
+    return dmxDataLength;
+  }
+
+  inline uint8_t getSequence(void)
+  {
+    return sequence;
+  }
+
+  inline uint8_t getPriority(void)
+  {
+    return priority;
+  }
+
+  inline IPAddress getRemoteIP(void)
+  {
+    return remoteIP;
+  }
+
+  // Packets dropped because they are not sACN, preview data or too big
+  inline uint32_t getRejectedPackets(void)
+  {
+    return rejectedPackets;
+  }
+
+  // Packets ignored because a higher priority source holds the universe,
+  // or E131_SOURCES other sources already send it
+  inline uint32_t getLowPriorityPackets(void)
+  {
+    return lowPriorityPackets;
+  }
+
+  inline SequenceTracker &getSequences(void)
+  {
+    return sequences;
+  }
+
+  // Same signature as the Artnet DMX callback. The sequence is already
+  // checked here, 0 is passed so an Art-Net tracker sees it as disabled
+  inline void setDmxCallback(void (*fptr)(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP))
+  {
+    dmxCallback = fptr;
+  }
+
+  inline void setSyncCallback(void (*fptr)(IPAddress remoteIP))
+  {
+    syncCallback = fptr;
+  }
+
+private:
+  struct UniverseSource
+  {
+    uint8_t priority;
+    unsigned long lastMillis;
+    // Sources sending at that priority
+    uint8_t cid[E131_SOURCES][E131_CID_SIZE];
+    unsigned long cidMillis[E131_SOURCES];
+    bool cidUsed[E131_SOURCES];
+  };
+
+#if defined(ARDUINO)
+  ArtnetUdpTransport defaultTransport;
+#endif
+  ArtnetTransport *transport;
+  int startUniverse = 0;
+  int nbUniverses = 0;
+  UniverseSource *sources = nullptr;
+  SequenceTracker sequences;
+  uint16_t syncAddress = 0; // sync universe announced by the last data packet
+
+  uint8_t packet[E131_MAX_PACKET];
+  int packetSize;
+  uint16_t incomingUniverse;
+  uint16_t dmxDataLength;
+  uint8_t sequence;
+  uint8_t priority;
+  IPAddress remoteIP;
+  uint32_t rejectedPackets = 0;
+  uint32_t lowPriorityPackets = 0;
+  void (*dmxCallback)(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP) = nullptr;
+  void (*syncCallback)(IPAddress remoteIP) = nullptr;
+
+  uint16_t readData();
+  uint16_t readSync();
+  int sourceSlot(UniverseSource &source, const uint8_t *cid, unsigned long now);
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * @brief Blend between the last two network frames at the wire rate
+ */
+
+#include "FrameInterpolator.h"
+
+FrameInterpolator::FrameInterpolator() : previous(nullptr), current(nullptr), size(0), frameStart(0), interval(0), frames(0) {}
+
+void FrameInterpolator::begin(int s)
+{
+  size = s;
+  free(previous);
+  free(current);
+  previous = (uint8_t *)calloc(size, 1);
+  current = (uint8_t *)calloc(size, 1);
+  interval = 0;
+  frames = 0;
+}
+
+uint8_t *FrameInterpolator::nextFrame(unsigned long now)
+{
+  uint32_t measured = now - frameStart;
+  if (frames > 0 && measured < INTERPOLATOR_MAX_INTERVAL_US)
+  {
+    // moving average over about 8 frames
+    interval = interval ? (interval * 7 + measured) / 8 : measured;
+  }
+
+  uint8_t *swap = previous;
+  previous = current;
+  current = swap;
+  frameStart = now;
+  frames++;
+  return current;
+}
+
+void FrameInterpolator::render(uint8_t *dest, unsigned long now)
+{
+  // t in 1/256, the current frame alone until there are two frames and an interval
+  uint32_t elapsed = now - frameStart;
+  uint32_t t = 256;
+  if (frames > 1 && interval > 0 && elapsed < interval)
+    t = elapsed * 256 / interval;
+
+  if (t >= 256)
+  {
+    memcpy(dest, current, size);
+    return;
+  }
+
+  for (int i = 0; i < size; i++)
+  {
+    int from = previous[i];
+    dest[i] = from + (((current[i] - from) * (int)t) >> 8);
+  }
+}
@@ -0,0 +1,52 @@
+/*
+ * @brief Blend between the last two network frames at the wire rate
+ *
+ * @details Media servers send 30-40 fps while short strips can take a few
+ * hundred. The interpolator keeps the previous and the current frame and,
+ * at every refresh, renders previous + (current - previous) * t where t
+ * goes from 0 to 1 over the measured interval between network frames.
+ * This costs one frame of latency and no extra network bandwidth.
+ *
+ */
+
+#ifndef FRAME_INTERPOLATOR_H
+#define FRAME_INTERPOLATOR_H
+
+#include <Arduino.h>
+
+// Longer gaps are pauses of the sender, not part of the frame rate
+#define INTERPOLATOR_MAX_INTERVAL_US 200000
+
+class FrameInterpolator
+{
+public:
+  FrameInterpolator();
+
+  void begin(int size);
+  // Buffer where the frame received at now must be written. The current
+  // frame becomes the start of the blend
+  uint8_t *nextFrame(unsigned long now);
+  // Write the blend for time now into dest
+  void render(uint8_t *dest, unsigned long now);
+
+  inline bool isReady(void)
+  {
+    return frames > 0;
+  }
+
+  // Smoothed time between two network frames, in us
+  inline uint32_t getInterval(void)
+  {
+    return interval;
+  }
+
+private:
+  uint8_t *previous;
+  uint8_t *current;
+  int size;
+  unsigned long frameStart;
+  uint32_t interval;
+  uint32_t frames;
+};
+
+#endif
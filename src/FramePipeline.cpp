@@ -0,0 +1,248 @@
+/*
+ * @brief DMX packets to led frames, shared by the firmware and the workstation build
+ */
+
+#include "FramePipeline.h"
+#include "ArtnetGithub.h"
+#include "PixelBlit.h"
+
+FramePipeline::FramePipeline()
+    : output(nullptr), scheduler(nullptr), blitter(nullptr), received(nullptr), sequences(nullptr), merger(nullptr),
+      power(nullptr), perf(nullptr), lut(nullptr), dither(nullptr), interpolator(nullptr), recorder(nullptr),
+      ingest(nullptr), frameBytes(0), syncMode(false), coalesce(true), syncActive(false), lastSyncTime(0)
+{
+}
+
+void FramePipeline::begin(PixelOutput *o, ShowScheduler *s, UniverseBlit *b, UniverseTracker *r,
+                          SequenceTracker *seq, UniverseMerger *m, PowerLimiter *p, PerfCounters *pc,
+                          uint8_t *buffer, uint32_t bytes)
+{
+  output = o;
+  scheduler = s;
+  blitter = b;
+  received = r;
+  sequences = seq;
+  merger = m;
+  power = p;
+  perf = pc;
+  ingest = buffer;
+  frameBytes = bytes;
+}
+
+void FramePipeline::setColorLut(const ColorLut *l)
+{
+  lut = l;
+}
+
+void FramePipeline::setDither(Dither *d)
+{
+  dither = d;
+}
+
+void FramePipeline::setInterpolator(FrameInterpolator *i)
+{
+  interpolator = i;
+}
+
+void FramePipeline::setRecorder(SceneRecorder *r)
+{
+  recorder = r;
+}
+
+void FramePipeline::setSyncMode(bool s)
+{
+  syncMode = s;
+}
+
+void FramePipeline::setCoalesce(bool c)
+{
+  coalesce = c;
+}
+
+void FramePipeline::receive(int index, uint8_t sequence, const uint8_t *data, uint16_t length, IPAddress remoteIP)
+{
+  // The controller stopped sending ArtSync : show on complete frames instead of freezing
+  bool synced = syncMode && updateSyncState();
+
+  // Late packets and senders beyond the two merged ones are ignored
+  const uint8_t *levels = acceptPacket(index, sequence, data, length, remoteIP);
+  if (!levels)
+    return;
+
+  // In sync mode the frame is whatever came in between two syncs
+  if (!synced)
+    received->mark(index);
+
+  blitUniverse(index, levels, length);
+
+  if (!synced && received->isComplete())
+  {
+    if (recorder)
+      recorder->endFrame(micros());
+    requestShow();
+    received->reset();
+  }
+}
+
+void FramePipeline::sync()
+{
+  lastSyncTime = millis();
+  if (!syncActive)
+  {
+    syncActive = true;
+    // Frames are now built between two syncs, forget the partial free-run frame
+    received->reset();
+    Serial.println("ArtSync received, sync mode");
+  }
+  if (recorder)
+    recorder->endFrame(micros());
+  requestShow();
+}
+
+bool FramePipeline::updateSyncState()
+{
+  if (syncActive && millis() - lastSyncTime > ART_SYNC_TIMEOUT_MS)
+  {
+    syncActive = false;
+    perf->syncTimeouts++;
+    received->reset();
+    Serial.println("No ArtSync, free-run mode");
+  }
+  return syncActive;
+}
+
+void FramePipeline::update()
+{
+  // begin() not called yet
+  if (output == nullptr)
+    return;
+
+  if (dither || interpolator)
+  {
+    // refresh the last frame as fast as the wire allows
+    bool ready = interpolator ? interpolator->isReady() : dither->isReady();
+    if (ready && !output->busy())
+      refreshFrame();
+  }
+  else if (scheduler->isPending() && !output->busy())
+  {
+    // push the frame that was waiting for the bus
+    showFrame();
+  }
+}
+
+void FramePipeline::blitUniverse(int index, const uint8_t *data, int length)
+{
+  // the dither applies the tables itself, after its error diffusion. The
+  // power budget still counts the levels after them : its scale dims those
+  if (dither)
+    blitter->blit(ingest, index, data, length, nullptr, lut);
+  else
+    blitter->blit(ingest, index, data, length, lut);
+}
+
+void FramePipeline::resetFrame()
+{
+  received->reset();
+}
+
+// Sequence check and merge of a DMX packet. Return the levels to copy to the
+// leds, or nullptr when the packet must be ignored
+const uint8_t *FramePipeline::acceptPacket(int index, uint8_t sequence, const uint8_t *data, uint16_t &length, IPAddress remoteIP)
+{
+  unsigned long now = millis();
+  bool assigned;
+  int slot = merger->source(index, remoteIP, now, assigned);
+  if (slot < 0)
+    return nullptr;
+  // A new sender in a freed slot : the sequence of the previous one means nothing
+  if (assigned)
+    sequences->restart(index * MERGE_SOURCES + slot);
+
+  // A late packet belongs to an older frame : never let it overwrite newer pixels
+  if (!sequences->accept(index * MERGE_SOURCES + slot, sequence))
+    return nullptr;
+
+  const uint8_t *levels = merger->merge(index, slot, data, length, now);
+  if (recorder)
+    recorder->addUniverse(index, levels, length);
+  return levels;
+}
+
+// Copy the completed frame out of the ingest buffer, dimmed if a strip is over its power budget
+void FramePipeline::commitFrame(uint8_t *dest)
+{
+  uint16_t scale = power->getScale();
+  if (scale < POWER_SCALE_FULL)
+    perf->limited++;
+  if (dither)
+  {
+    // the buffer still holds DMX values, the dither dims after its gamma tables
+    dither->setScale(scale);
+    memcpy(dest, ingest, frameBytes);
+  }
+  else if (scale < POWER_SCALE_FULL)
+  {
+    copyScaled(dest, ingest, frameBytes, scale);
+  }
+  else
+  {
+    memcpy(dest, ingest, frameBytes);
+  }
+}
+
+// A frame is complete. Show it now if the bus is free, else update() will
+// push it once the previous frame is out : the network is never blocked.
+// If an older frame was still waiting it is replaced, only the newest
+// completed frame goes out
+void FramePipeline::requestShow()
+{
+  if (interpolator)
+  {
+    // update() blends towards this frame until the next one comes
+    commitFrame(interpolator->nextFrame(micros()));
+    return;
+  }
+  if (dither)
+  {
+    // update() keeps refreshing the newest frame
+    if (!dither->isRendered())
+      perf->skipped++;
+    commitFrame(dither->getSource());
+    dither->newFrame();
+    return;
+  }
+
+  // the drawing memory is only read by show(), it can change while the bus is busy
+  commitFrame(output->getDrawingMemory());
+
+  if (!output->busy() || !coalesce)
+  {
+    showFrame(); // without coalesce, show() waits for the bus
+    return;
+  }
+  if (scheduler->isPending())
+    perf->skipped++;
+  scheduler->setPending(true);
+}
+
+// Send the drawing memory to the leds, timed for the counters
+void FramePipeline::showFrame()
+{
+  unsigned long start = micros();
+  output->show();
+  scheduler->setPending(false);
+  perf->addShowTime(micros() - start);
+}
+
+// Dither and interpolate modes : render the next refresh and show it.
+// With both, the blend is dithered : it goes through the dither source
+void FramePipeline::refreshFrame()
+{
+  uint8_t *drawing = output->getDrawingMemory();
+  if (interpolator)
+    interpolator->render(dither ? dither->getSource() : drawing, micros());
+  if (dither)
+    dither->render(drawing, lut);
+  showFrame();
+}
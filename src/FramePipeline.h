@@ -0,0 +1,100 @@
+/*
+ * @brief DMX packets to led frames, shared by the firmware and the workstation build
+ *
+ * @details receive() drops the late packets (SequenceTracker), merges two
+ * senders (UniverseMerger) and copies the levels into the ingest buffer
+ * through UniverseBlit. When all the universes are in, or on ArtSync in
+ * sync mode, requestShow() dims the frame to the power budget and hands it
+ * to the output : shown at once if the bus is free, else kept pending
+ * until update() finds the bus free (coalesce). In dither and interpolate
+ * modes the frame goes to Dither / FrameInterpolator instead, and update()
+ * refreshes the leds as fast as the wire allows.
+ * Without ArtSync for ART_SYNC_TIMEOUT_MS, sync mode falls back to
+ * showing complete frames.
+ *
+ */
+
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <Arduino.h>
+#include "PixelOutput.h"
+#include "UniverseBlit.h"
+#include "UniverseTracker.h"
+#include "SequenceTracker.h"
+#include "UniverseMerger.h"
+#include "PowerLimiter.h"
+#include "ShowScheduler.h"
+#include "PerfCounters.h"
+#include "ColorLut.h"
+#include "Dither.h"
+#include "FrameInterpolator.h"
+#include "SceneRecorder.h"
+
+class FramePipeline
+{
+public:
+  FramePipeline();
+
+  // All the parts are owned by the caller and already begun. ingest holds frameBytes bytes, in wire order
+  void begin(PixelOutput *output, ShowScheduler *scheduler, UniverseBlit *blitter, UniverseTracker *received,
+             SequenceTracker *sequences, UniverseMerger *merger, PowerLimiter *power, PerfCounters *perf,
+             uint8_t *ingest, uint32_t frameBytes);
+  // Optional parts, nullptr to disable. With dither the lut is applied by the dither, not by the blit
+  void setColorLut(const ColorLut *lut);
+  void setDither(Dither *dither);
+  void setInterpolator(FrameInterpolator *interpolator);
+  void setRecorder(SceneRecorder *recorder);
+  // Sync mode : frames are shown on ArtSync, not when complete
+  void setSyncMode(bool sync);
+  // Keep a completed frame pending while the bus is busy, instead of waiting for it
+  void setCoalesce(bool coalesce);
+
+  // A DMX packet of universe index (0 is startuniverse)
+  void receive(int index, uint8_t sequence, const uint8_t *data, uint16_t length, IPAddress remoteIP);
+  // ArtSync, or sACN sync
+  void sync();
+  // To be called from loop() : pending frame, dither and interpolation refresh
+  void update();
+
+  // Copy already accepted levels, for the scene player. The frame is shown by requestShow()
+  void blitUniverse(int index, const uint8_t *data, int length);
+  // The ingest buffer holds a complete frame
+  void requestShow();
+  // Forget the universes of the partial frame
+  void resetFrame();
+  // Return true while ArtSync drives the show, false in free-run
+  bool updateSyncState();
+
+  inline bool isSyncActive(void)
+  {
+    return syncActive;
+  }
+
+private:
+  PixelOutput *output;
+  ShowScheduler *scheduler;
+  UniverseBlit *blitter;
+  UniverseTracker *received;
+  SequenceTracker *sequences;
+  UniverseMerger *merger;
+  PowerLimiter *power;
+  PerfCounters *perf;
+  const ColorLut *lut;
+  Dither *dither;
+  FrameInterpolator *interpolator;
+  SceneRecorder *recorder;
+  uint8_t *ingest;
+  uint32_t frameBytes;
+  bool syncMode;
+  bool coalesce;
+  bool syncActive; // sync mode : false until the first ArtSync and after ART_SYNC_TIMEOUT_MS without one
+  unsigned long lastSyncTime;
+
+  const uint8_t *acceptPacket(int index, uint8_t sequence, const uint8_t *data, uint16_t &length, IPAddress remoteIP);
+  void commitFrame(uint8_t *dest);
+  void showFrame();
+  void refreshFrame();
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * @brief Runtime counters, to see how close a node is to its limits
+ */
+
+#include "PerfCounters.h"
+#include "ArtnetGithub.h"
+#include "E131.h"
+
+PerfCounters::PerfCounters()
+{
+  reset();
+  dmxPerSecond = 0;
+  framesPerSecond = 0;
+  loopsPerSecond = 0;
+  windowStart = 0;
+}
+
+void PerfCounters::reset()
+{
+  artDmx = 0;
+  artPoll = 0;
+  artSync = 0;
+  syncTimeouts = 0;
+  sacnDmx = 0;
+  sacnSync = 0;
+  frames = 0;
+  skipped = 0;
+  limited = 0;
+  showCount = 0;
+  showMin = 0xFFFFFFFF;
+  showMax = 0;
+  showTotal = 0;
+  callbackTotal = 0;
+  loops = 0;
+  windowDmx = 0;
+  windowFrames = 0;
+  windowLoops = 0;
+}
+
+void PerfCounters::countPacket(uint16_t opcode)
+{
+  switch (opcode)
+  {
+  case ART_DMX:
+    artDmx++;
+    break;
+  case ART_POLL:
+    artPoll++;
+    break;
+  case ART_SYNC:
+    artSync++;
+    break;
+  case E131_DATA:
+    sacnDmx++;
+    break;
+  case E131_SYNC:
+    sacnSync++;
+    break;
+  }
+}
+
+void PerfCounters::addShowTime(uint32_t us)
+{
+  frames++;
+  showCount++;
+  showTotal += us;
+  if (us < showMin)
+    showMin = us;
+  if (us > showMax)
+    showMax = us;
+}
+
+bool PerfCounters::update(unsigned long now)
+{
+  unsigned long elapsed = now - windowStart;
+  if (elapsed < PERF_WINDOW_MS)
+    return false;
+
+  dmxPerSecond = (uint64_t)(artDmx + sacnDmx - windowDmx) * 1000 / elapsed;
+  framesPerSecond = (uint64_t)(frames - windowFrames) * 1000 / elapsed;
+  loopsPerSecond = (uint64_t)(loops - windowLoops) * 1000 / elapsed;
+  windowDmx = artDmx + sacnDmx;
+  windowFrames = frames;
+  windowLoops = loops;
+  windowStart = now;
+  return true;
+}
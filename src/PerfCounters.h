@@ -0,0 +1,66 @@
+/*
+ * @brief Runtime counters, to see how close a node is to its limits
+ *
+ * @details Cumulative counters since the last reset plus the rates of the
+ * last one second window. Everything is plain integer math, cheap enough
+ * to be updated from the DMX callbacks.
+ *
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <Arduino.h>
+
+#define PERF_WINDOW_MS 1000
+
+struct PerfCounters
+{
+  // Packets returned by Artnet::read, per opcode
+  uint32_t artDmx;
+  uint32_t artPoll;
+  uint32_t artSync;
+  // Fallbacks to free-run because ArtSync stopped
+  uint32_t syncTimeouts;
+  // Packets returned by E131::read
+  uint32_t sacnDmx;
+  uint32_t sacnSync;
+  // Frames sent to the leds, and completed frames replaced by a newer one while the bus was busy
+  uint32_t frames;
+  uint32_t skipped;
+  // Frames dimmed by the power limiter
+  uint32_t limited;
+  // Duration of leds->show(), in us
+  uint32_t showCount;
+  uint32_t showMin;
+  uint32_t showMax;
+  uint64_t showTotal;
+  // Time spent in Artnet::read and E131::read for DMX and sync packets, callbacks included, in us
+  uint64_t callbackTotal;
+  uint32_t loops;
+
+  // Rates of the last complete window, per second. Art-Net and sACN DMX packets together
+  uint32_t dmxPerSecond;
+  uint32_t framesPerSecond;
+  uint32_t loopsPerSecond;
+
+  PerfCounters();
+  void reset();
+  void countPacket(uint16_t opcode);
+  void addShowTime(uint32_t us);
+  // Return true when a new window started, the rates have been refreshed
+  bool update(unsigned long now);
+
+  inline uint32_t getShowAverage(void)
+  {
+    return showCount ? (uint32_t)(showTotal / showCount) : 0;
+  }
+
+private:
+  unsigned long windowStart;
+  uint32_t windowDmx;
+  uint32_t windowFrames;
+  uint32_t windowLoops;
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * @brief Bulk copy of DMX RGB data into the OctoWS2811 drawing memory
+ */
+
+#include "PixelBlit.h"
+
+// Position on the wire of red, green and blue, for each PixelOrder
+static const uint8_t wireIndex[6][3] = {
+    {0, 1, 2}, // RGB
+    {0, 2, 1}, // RBG
+    {1, 0, 2}, // GRB
+    {2, 0, 1}, // GBR
+    {1, 2, 0}, // BRG
+    {2, 1, 0}, // BGR
+};
+
+const uint8_t wireColor[6][3] = {
+    {0, 1, 2}, // RGB
+    {0, 2, 1}, // RBG
+    {1, 0, 2}, // GRB
+    {1, 2, 0}, // GBR
+    {2, 0, 1}, // BRG
+    {2, 1, 0}, // BGR
+};
+
+// Sum of the 4 bytes of a word, two lanes of 16 bits added at the end
+static inline uint32_t byteSum(uint32_t w)
+{
+  uint32_t lanes = (w & 0x00FF00FF) + ((w >> 8) & 0x00FF00FF);
+  return (lanes & 0xFFFF) + (lanes >> 16);
+}
+
+static const char *orderNames[6] = {"RGB", "RBG", "GRB", "GBR", "BRG", "BGR"};
+
+// Generic path : one output byte per input byte, permutation known at compile time.
+// N is 3, or 4 for RGBW where the white byte goes last. DIR is 1, or -1 to fill the leds backwards
+template <int N, int C0, int C1, int C2, int DIR>
+static uint32_t blitOrdered(uint8_t *dest, const uint8_t *src, uint32_t count)
+{
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    dest[0] = src[C0];
+    dest[1] = src[C1];
+    dest[2] = src[C2];
+    sum += src[0] + src[1] + src[2];
+    if (N == 4)
+    {
+      dest[3] = src[3];
+      sum += src[3];
+    }
+    dest += DIR * N;
+    src += N;
+  }
+  return sum;
+}
+
+// Same with the color tables applied on the way
+template <int N, int C0, int C1, int C2, int DIR>
+static uint32_t blitOrderedLut(uint8_t *dest, const uint8_t *src, uint32_t count, const ColorLut *lut)
+{
+  const uint8_t *t0 = lut->table[C0];
+  const uint8_t *t1 = lut->table[C1];
+  const uint8_t *t2 = lut->table[C2];
+  const uint8_t *t3 = lut->table[3];
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    dest[0] = t0[src[C0]];
+    dest[1] = t1[src[C1]];
+    dest[2] = t2[src[C2]];
+    sum += dest[0] + dest[1] + dest[2];
+    if (N == 4)
+    {
+      dest[3] = t3[src[3]];
+      sum += dest[3];
+    }
+    dest += DIR * N;
+    src += N;
+  }
+  return sum;
+}
+
+// Order switch of the generic paths
+template <int N, int DIR>
+static uint32_t blitAnyOrder(uint8_t *dest, const uint8_t *src, uint32_t count, uint8_t order, const ColorLut *lut)
+{
+  if (lut && !lut->identity)
+  {
+    switch (order)
+    {
+    case PIXEL_RGB:
+      return blitOrderedLut<N, 0, 1, 2, DIR>(dest, src, count, lut);
+    case PIXEL_RBG:
+      return blitOrderedLut<N, 0, 2, 1, DIR>(dest, src, count, lut);
+    case PIXEL_GRB:
+      return blitOrderedLut<N, 1, 0, 2, DIR>(dest, src, count, lut);
+    case PIXEL_GBR:
+      return blitOrderedLut<N, 1, 2, 0, DIR>(dest, src, count, lut);
+    case PIXEL_BRG:
+      return blitOrderedLut<N, 2, 0, 1, DIR>(dest, src, count, lut);
+    case PIXEL_BGR:
+      return blitOrderedLut<N, 2, 1, 0, DIR>(dest, src, count, lut);
+    }
+    return 0;
+  }
+
+  switch (order)
+  {
+  case PIXEL_RGB:
+    return blitOrdered<N, 0, 1, 2, DIR>(dest, src, count);
+  case PIXEL_RBG:
+    return blitOrdered<N, 0, 2, 1, DIR>(dest, src, count);
+  case PIXEL_GRB:
+    return blitOrdered<N, 1, 0, 2, DIR>(dest, src, count);
+  case PIXEL_GBR:
+    return blitOrdered<N, 1, 2, 0, DIR>(dest, src, count);
+  case PIXEL_BRG:
+    return blitOrdered<N, 2, 0, 1, DIR>(dest, src, count);
+  case PIXEL_BGR:
+    return blitOrdered<N, 2, 1, 0, DIR>(dest, src, count);
+  }
+  return 0;
+}
+
+// No reordering : word copy of size bytes
+static uint32_t blitCopy(uint8_t *dest, const uint8_t *src, uint32_t size)
+{
+  uint32_t words = size / 4;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < words; i++)
+  {
+    uint32_t w;
+    memcpy(&w, src, 4);
+    memcpy(dest, &w, 4);
+    sum += byteSum(w);
+    dest += 4;
+    src += 4;
+  }
+  for (uint32_t i = words * 4; i < size; i++)
+  {
+    *dest++ = *src;
+    sum += *src++;
+  }
+  return sum;
+}
+
+// GRB is what almost every strip uses : swap R and G of 4 leds (12 bytes)
+// with three 32 bits words instead of twelve byte moves
+static uint32_t blitGRB(uint8_t *dest, const uint8_t *src, uint32_t count)
+{
+  uint32_t blocks = count / 4;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < blocks; i++)
+  {
+    uint32_t w0, w1, w2;
+    memcpy(&w0, src, 4);     // R0 G0 B0 R1
+    memcpy(&w1, src + 4, 4); // G1 B1 R2 G2
+    memcpy(&w2, src + 8, 4); // B2 R3 G3 B3
+
+    // G0 R0 B0 G1 | R1 B1 G2 R2 | B2 G3 R3 B3
+    uint32_t o0 = ((w0 >> 8) & 0x000000FF) | ((w0 << 8) & 0x0000FF00) | (w0 & 0x00FF0000) | (w1 << 24);
+    uint32_t o1 = (w0 >> 24) | (w1 & 0x0000FF00) | ((w1 >> 8) & 0x00FF0000) | ((w1 << 8) & 0xFF000000);
+    uint32_t o2 = (w2 & 0xFF0000FF) | ((w2 >> 8) & 0x0000FF00) | ((w2 << 8) & 0x00FF0000);
+    sum += byteSum(w0) + byteSum(w1) + byteSum(w2);
+
+    memcpy(dest, &o0, 4);
+    memcpy(dest + 4, &o1, 4);
+    memcpy(dest + 8, &o2, 4);
+    dest += 12;
+    src += 12;
+  }
+  return sum + blitOrdered<3, 1, 0, 2, 1>(dest, src, count - blocks * 4);
+}
+
+// SK6812 GRBW : one led is one 32 bits word, swap its two low bytes
+static uint32_t blitGRBW(uint8_t *dest, const uint8_t *src, uint32_t count)
+{
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t w;
+    memcpy(&w, src, 4); // R G B W
+    uint32_t o = (w & 0xFFFF0000) | ((w >> 8) & 0x000000FF) | ((w << 8) & 0x0000FF00);
+    sum += byteSum(w);
+    memcpy(dest, &o, 4);
+    dest += 4;
+    src += 4;
+  }
+  return sum;
+}
+
+uint32_t blitPixels(uint8_t *drawing, uint32_t firstPixel, const uint8_t *rgb, uint32_t count, uint8_t order, const ColorLut *lut)
+{
+  int n = pixelChannels(order);
+  uint8_t *dest = drawing + firstPixel * n;
+  uint8_t colors = order & PIXEL_ORDER_MASK;
+
+  if (!lut || lut->identity)
+  {
+    if (colors == PIXEL_RGB)
+      return blitCopy(dest, rgb, count * n);
+    if (colors == PIXEL_GRB)
+      return n == 4 ? blitGRBW(dest, rgb, count) : blitGRB(dest, rgb, count);
+  }
+  if (n == 4)
+    return blitAnyOrder<4, 1>(dest, rgb, count, colors, lut);
+  return blitAnyOrder<3, 1>(dest, rgb, count, colors, lut);
+}
+
+uint32_t blitPixelsReverse(uint8_t *drawing, uint32_t firstPixel, const uint8_t *rgb, uint32_t count, uint8_t order, const ColorLut *lut)
+{
+  int n = pixelChannels(order);
+  uint8_t *dest = drawing + firstPixel * n;
+
+  if (n == 4)
+    return blitAnyOrder<4, -1>(dest, rgb, count, order & PIXEL_ORDER_MASK, lut);
+  return blitAnyOrder<3, -1>(dest, rgb, count, order & PIXEL_ORDER_MASK, lut);
+}
+
+uint32_t blitComponents(uint8_t *drawing, uint32_t pixel, int first, const uint8_t *data, int count, uint8_t order, const ColorLut *lut)
+{
+  uint8_t *dest = drawing + pixel * pixelChannels(order);
+  uint8_t colors = order & PIXEL_ORDER_MASK;
+  uint32_t sum = 0;
+  for (int i = 0; i < count; i++)
+  {
+    int c = first + i;
+    uint8_t value = lut ? lut->table[c][data[i]] : data[i];
+    // white is always the last byte on the wire
+    dest[c == 3 ? 3 : wireIndex[colors][c]] = value;
+    sum += value;
+  }
+  return sum;
+}
+
+uint32_t sumThroughLut(const uint8_t *data, int first, int count, int channels, const ColorLut *lut)
+{
+  uint32_t sum = 0;
+  int c = first;
+  for (int i = 0; i < count; i++)
+  {
+    sum += lut->table[c][data[i]];
+    if (++c == channels)
+      c = 0;
+  }
+  return sum;
+}
+
+uint8_t pixelOrderFromName(const char *name, uint8_t fallback)
+{
+  if (name == nullptr)
+    return fallback;
+  for (int i = 0; i < 6; i++)
+  {
+    // "GRBW" : same colors, white last
+    if (!strncmp(name, orderNames[i], 3))
+    {
+      if (name[3] == 0)
+        return i;
+      if (!strcmp(name + 3, "W"))
+        return i | PIXEL_W;
+    }
+  }
+  return fallback;
+}
+
+void copyScaled(uint8_t *dest, const uint8_t *src, uint32_t size, uint16_t scale)
+{
+  for (uint32_t i = 0; i < size; i++)
+    dest[i] = (src[i] * scale) >> 8;
+}
@@ -0,0 +1,63 @@
+/*
+ * @brief Bulk copy of DMX RGB data into the OctoWS2811 drawing memory
+ *
+ * @details On Teensy 4.x OctoWS2811 keeps its drawing memory as plain bytes,
+ * 3 per led, already in wire color order, led n at offset n * 3
+ * (strip * ledsperstrip + index). The bit transpose is done by the library
+ * while clocking the frame out. setPixel() does index math and color
+ * shuffling for every single led ; blitPixels() does the same job for a
+ * whole universe in one loop.
+ * RGBW leds (SK6812) take 4 bytes, the white one last on the wire : the
+ * order then carries PIXEL_W and the same copies run with a 4 bytes stride.
+ *
+ */
+
+#ifndef PIXEL_BLIT_H
+#define PIXEL_BLIT_H
+
+#include <Arduino.h>
+#include "ColorLut.h"
+
+// Wire color order. Same order as the WS2811_RGB .. WS2811_BGR constants
+enum PixelOrder
+{
+  PIXEL_RGB,
+  PIXEL_RBG,
+  PIXEL_GRB,
+  PIXEL_GBR,
+  PIXEL_BRG,
+  PIXEL_BGR
+};
+// Added to a PixelOrder for RGBW leds : 4 channels per pixel, white last
+#define PIXEL_W 0x08
+#define PIXEL_ORDER_MASK 0x07
+
+// Channels, and bytes on the wire, of one pixel of that order
+inline int pixelChannels(uint8_t order)
+{
+  return (order & PIXEL_W) ? 4 : 3;
+}
+
+// Color (0 red, 1 green, 2 blue) of each wire byte of a led, for each PixelOrder
+extern const uint8_t wireColor[6][3];
+
+// Copy count RGB triplets (RGBW quadruplets) from rgb into drawing, starting at led firstPixel.
+// When lut is given, the color tables are applied during the copy.
+// Return the sum of the bytes written, for the power budget
+uint32_t blitPixels(uint8_t *drawing, uint32_t firstPixel, const uint8_t *rgb, uint32_t count, uint8_t order, const ColorLut *lut = nullptr);
+// Same, the leds going backwards from firstPixel : the reversed lines of a serpentine layout
+uint32_t blitPixelsReverse(uint8_t *drawing, uint32_t firstPixel, const uint8_t *rgb, uint32_t count, uint8_t order, const ColorLut *lut = nullptr);
+// Write count color components of led pixel, starting at component first (0 red, 1 green, 2 blue, 3 white).
+// Used for the pixels split between two universes. Return the sum of the bytes written
+uint32_t blitComponents(uint8_t *drawing, uint32_t pixel, int first, const uint8_t *data, int count, uint8_t order, const ColorLut *lut = nullptr);
+// Sum of count components through the tables, data starting at component first of pixels of channels components.
+// The power budget of a copy that leaves the tables to a later stage (dither)
+uint32_t sumThroughLut(const uint8_t *data, int first, int count, int channels, const ColorLut *lut);
+
+// "GRB" -> PIXEL_GRB, "GRBW" -> PIXEL_GRB | PIXEL_W, fallback when the name is unknown
+uint8_t pixelOrderFromName(const char *name, uint8_t fallback);
+
+// dest = src * scale / 256, the power limiter dimming
+void copyScaled(uint8_t *dest, const uint8_t *src, uint32_t size, uint16_t scale);
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * @brief Where each pixel of the universes lands on the strips
+ */
+
+#include "PixelMap.h"
+
+PixelMap::PixelMap() : runs(nullptr), numberOfRuns(0), capacity(0), numberOfStrips(0), ledsPerStrip(0), numberOfPixels(0) {}
+
+void PixelMap::begin(int leds)
+{
+  ledsPerStrip = leds;
+  numberOfRuns = 0;
+  numberOfStrips = 0;
+  numberOfPixels = 0;
+}
+
+void PixelMap::addRun(uint32_t physical, int count, uint8_t order, int8_t step)
+{
+  if (numberOfRuns == capacity)
+  {
+    capacity = capacity ? capacity * 2 : 16;
+    runs = (PixelRun *)realloc(runs, capacity * sizeof(PixelRun));
+  }
+  PixelRun &run = runs[numberOfRuns++];
+  run.first = numberOfPixels;
+  run.physical = physical;
+  run.count = count;
+  run.strip = numberOfStrips;
+  run.order = order;
+  run.step = step;
+  numberOfPixels += count;
+}
+
+void PixelMap::addStrip(int leds, uint8_t order, int ledsPerLine, bool serpentine)
+{
+  if (numberOfStrips >= PIXEL_MAX_STRIPS)
+    return;
+  // The OctoWS2811 buffer stops at ledsPerStrip
+  leds = min(leds, ledsPerStrip);
+  uint32_t base = numberOfStrips * ledsPerStrip;
+
+  if (!serpentine || ledsPerLine <= 0 || ledsPerLine >= leds)
+  {
+    if (leds > 0)
+      addRun(base, leds, order, 1);
+  }
+  else
+  {
+    for (int start = 0, line = 0; start < leds; start += ledsPerLine, line++)
+    {
+      int count = min(ledsPerLine, leds - start);
+      if (line & 1)
+        addRun(base + start + count - 1, count, order, -1);
+      else
+        addRun(base + start, count, order, 1);
+    }
+  }
+  numberOfStrips++;
+}
+
+int PixelMap::findRun(uint32_t pixel)
+{
+  if (pixel >= numberOfPixels)
+    return -1;
+  // Last run starting at or before pixel
+  int low = 0;
+  int high = numberOfRuns - 1;
+  while (low < high)
+  {
+    int mid = (low + high + 1) / 2;
+    if (runs[mid].first <= pixel)
+      low = mid;
+    else
+      high = mid - 1;
+  }
+  return low;
+}
@@ -0,0 +1,78 @@
+/*
+ * @brief Where each pixel of the universes lands on the strips
+ *
+ * @details The universes carry the pixels of the strips one after the
+ * other, each strip with its own length, color order and line layout. The
+ * map is compiled once at load time into runs : consecutive pixels going
+ * to consecutive leds of one strip, forwards or backwards (the odd lines
+ * of a serpentine layout). The universe copy walks the runs and calls the
+ * bulk blit on each, there is no per pixel lookup.
+ *
+ */
+
+#ifndef PIXEL_MAP_H
+#define PIXEL_MAP_H
+
+#include <Arduino.h>
+
+// Outputs of OctoWS2811, arduinopins of the configuration
+#define PIXEL_MAX_STRIPS 8
+
+struct PixelRun
+{
+  uint32_t first;    // first pixel of the run, in universe order
+  uint32_t physical; // OctoWS2811 led of that first pixel
+  uint16_t count;
+  uint8_t strip;
+  uint8_t order; // PixelOrder of the strip
+  int8_t step;   // 1, or -1 when the leds go backwards
+};
+
+class PixelMap
+{
+public:
+  PixelMap();
+
+  // ledsPerStrip is the OctoWS2811 strip size, the longest strip
+  void begin(int ledsPerStrip);
+  // Next strip. ledsPerLine is only used by a serpentine layout, where one
+  // line out of two goes backwards. The last line may be shorter
+  void addStrip(int leds, uint8_t order, int ledsPerLine, bool serpentine);
+
+  // Run holding pixel, -1 past the last strip
+  int findRun(uint32_t pixel);
+
+  inline const PixelRun &getRun(int index)
+  {
+    return runs[index];
+  }
+
+  inline int getNumberOfRuns(void)
+  {
+    return numberOfRuns;
+  }
+
+  // Pixels of all the strips
+  inline uint32_t getNumberOfPixels(void)
+  {
+    return numberOfPixels;
+  }
+
+  // OctoWS2811 led of pixel, in a run returned by findRun
+  inline uint32_t getPhysical(const PixelRun &run, uint32_t pixel)
+  {
+    return run.physical + run.step * (int32_t)(pixel - run.first);
+  }
+
+private:
+  PixelRun *runs;
+  int numberOfRuns;
+  int capacity;
+  int numberOfStrips;
+  int ledsPerStrip;
+  uint32_t numberOfPixels;
+
+  void addRun(uint32_t physical, int count, uint8_t order, int8_t step);
+};
+
+#endif
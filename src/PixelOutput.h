@@ -0,0 +1,57 @@
+/*
+ * @brief Led output abstraction used by the frame path
+ *
+ * @details The frame path only needs a drawing memory to fill (bytes in
+ * wire order, ledsperstrip leds per strip, strip after strip), show() and
+ * busy(). OctoPixelOutput drives the strips on the Teensy, a workstation
+ * build records the frames instead (see host/FramePixelOutput.h).
+ *
+ */
+
+#ifndef PIXEL_OUTPUT_H
+#define PIXEL_OUTPUT_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO)
+#include <OctoWS2811.h>
+#endif
+
+class PixelOutput
+{
+public:
+  virtual ~PixelOutput() {}
+
+  virtual void begin() = 0;
+  // Send the drawing memory to the leds. Waits while the previous frame is going out
+  virtual void show() = 0;
+  // Non zero while a frame is going out
+  virtual int busy() = 0;
+  // Single led, in the color order of the output. For the test patterns
+  virtual void setPixel(uint32_t num, uint8_t red, uint8_t green, uint8_t blue) = 0;
+  virtual uint8_t *getDrawingMemory() = 0;
+};
+
+#if defined(ARDUINO)
+// Default output : OctoWS2811, 8 strips in parallel
+class OctoPixelOutput : public PixelOutput
+{
+public:
+  OctoPixelOutput(uint32_t ledsPerStrip, void *displayMemory, void *drawingMemory, uint8_t config, uint8_t numPins, const uint8_t *pinList)
+      : leds(ledsPerStrip, displayMemory, drawingMemory, config, numPins, pinList), drawing((uint8_t *)drawingMemory)
+  {
+  }
+
+  void begin() { leds.begin(); }
+  void show() { leds.show(); }
+  int busy() { return leds.busy(); }
+  void setPixel(uint32_t num, uint8_t red, uint8_t green, uint8_t blue) { leds.setPixel(num, red, green, blue); }
+  uint8_t *getDrawingMemory() { return drawing; }
+
+private:
+  OctoWS2811 leds;
+  uint8_t *drawing;
+};
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * @brief Per strip current budget, computed while the universes come in
+ */
+
+#include "PowerLimiter.h"
+
+PowerLimiter::PowerLimiter()
+    : universeSums(nullptr), stripSums(nullptr), numberOfUniverses(0), numberOfStrips(0), stripMilliamps(0), channelMilliamps(0)
+{
+}
+
+void PowerLimiter::begin(int nbUniverses, int nbStrips, uint32_t stripMa, uint32_t channelMa)
+{
+  numberOfUniverses = nbUniverses;
+  numberOfStrips = nbStrips;
+  stripMilliamps = stripMa;
+  channelMilliamps = channelMa;
+  free(universeSums);
+  free(stripSums);
+  universeSums = (uint32_t *)calloc(nbUniverses * nbStrips, sizeof(uint32_t));
+  stripSums = (uint32_t *)calloc(nbStrips, sizeof(uint32_t));
+}
+
+void PowerLimiter::clearUniverse(int index)
+{
+  if (!isEnabled())
+    return;
+  uint32_t *sums = universeSums + index * numberOfStrips;
+  for (int s = 0; s < numberOfStrips; s++)
+  {
+    stripSums[s] -= sums[s];
+    sums[s] = 0;
+  }
+}
+
+uint32_t PowerLimiter::getStripMilliamps(int strip)
+{
+  return (uint64_t)stripSums[strip] * channelMilliamps / 255;
+}
+
+uint16_t PowerLimiter::getScale()
+{
+  if (!isEnabled())
+    return POWER_SCALE_FULL;
+
+  uint16_t scale = POWER_SCALE_FULL;
+  for (int s = 0; s < numberOfStrips; s++)
+  {
+    uint32_t milliamps = getStripMilliamps(s);
+    if (milliamps > stripMilliamps)
+    {
+      uint16_t stripScale = (uint64_t)stripMilliamps * POWER_SCALE_FULL / milliamps;
+      if (stripScale < scale)
+        scale = stripScale;
+    }
+  }
+  return scale;
+}
@@ -0,0 +1,58 @@
+/*
+ * @brief Per strip current budget, computed while the universes come in
+ *
+ * @details blitPixels returns the sum of the channel values it wrote. That
+ * sum is kept per universe and per strip, so when a universe is received
+ * again only its own contribution is replaced : the current of each strip
+ * is always known without scanning the frame. At commit time getScale()
+ * gives the dimming to apply when a strip is over budget. In dither mode
+ * the copy keeps the DMX values, the sums are taken through the gamma
+ * tables so they match the levels the dither dims.
+ *
+ */
+
+#ifndef POWER_LIMITER_H
+#define POWER_LIMITER_H
+
+#include <Arduino.h>
+
+// No dimming
+#define POWER_SCALE_FULL 256
+
+class PowerLimiter
+{
+public:
+  PowerLimiter();
+
+  // stripMilliamps 0 disables the limiter. channelMilliamps is the current of one channel at 255
+  void begin(int numberOfUniverses, int numberOfStrips, uint32_t stripMilliamps, uint32_t channelMilliamps);
+  // A universe is about to be copied again, forget what it brought last time
+  void clearUniverse(int index);
+  // Scale to apply to the whole frame, POWER_SCALE_FULL when every strip is within budget
+  uint16_t getScale();
+  uint32_t getStripMilliamps(int strip);
+
+  inline bool isEnabled(void)
+  {
+    return stripMilliamps > 0;
+  }
+
+  // Add the channel sum that universe index wrote into strip
+  inline void add(int index, int strip, uint32_t sum)
+  {
+    if (!isEnabled())
+      return;
+    universeSums[index * numberOfStrips + strip] += sum;
+    stripSums[strip] += sum;
+  }
+
+private:
+  uint32_t *universeSums; // [universe][strip]
+  uint32_t *stripSums;
+  int numberOfUniverses;
+  int numberOfStrips;
+  uint32_t stripMilliamps;
+  uint32_t channelMilliamps;
+};
+
+#endif
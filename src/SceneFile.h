@@ -0,0 +1,48 @@
+/*
+ * @brief Layout of the scene files played and recorded on the SD card
+ *
+ * @details Everything is a multiple of the 512 bytes SD block, so each
+ * record is read or written with whole block transfers :
+ *   - one SceneHeader block
+ *   - per frame, one SceneRecord block then one block per universe holding
+ *     the DMX levels as received (before color order, gamma and mapping).
+ * A scene recorded on a node plays back through the same universe copy as
+ * the network, so it follows the current configuration.
+ *
+ */
+
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <Arduino.h>
+
+#define SCENE_MAGIC "ANSC"
+#define SCENE_VERSION 1
+#define SCENE_BLOCK 512
+// Universes a SceneRecord block can describe
+#define SCENE_MAX_UNIVERSES 252
+
+struct SceneHeader
+{
+  char magic[4];
+  uint16_t version;
+  uint16_t numberOfUniverses;
+  uint32_t frameCount;  // informative, the file size gives the real count
+  uint32_t frameMicros; // mean interval between frames, used to loop
+  uint8_t reserved[SCENE_BLOCK - 16];
+} __attribute__((packed));
+
+struct SceneRecord
+{
+  uint32_t micros; // time since the first frame
+  uint32_t frame;
+  uint16_t length[SCENE_MAX_UNIVERSES]; // DMX channels of each universe, 0 when not received
+} __attribute__((packed));
+
+// Bytes of one record, SceneRecord block included
+inline uint32_t sceneRecordSize(int numberOfUniverses)
+{
+  return (uint32_t)(numberOfUniverses + 1) * SCENE_BLOCK;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * @brief Stand-alone playback of a scene file from the SD card
+ */
+
+#include "ScenePlayer.h"
+
+ScenePlayer::ScenePlayer()
+    : front(0), fill(0), recordSize(0), frameCount(0), nextRecord(0), frameMicros(0), lastMicros(0), loopOffset(0), startMicros(0), playing(false)
+{
+  buffers[0] = nullptr;
+  buffers[1] = nullptr;
+}
+
+bool ScenePlayer::open(const char *path, int numberOfUniverses)
+{
+  frameCount = 0;
+  file = SD.open(path, FILE_READ);
+  if (!file)
+    return false;
+
+  SceneHeader header;
+  if (file.read(&header, sizeof(header)) != sizeof(header) || memcmp(header.magic, SCENE_MAGIC, 4) != 0 || header.version != SCENE_VERSION)
+  {
+    Serial.println("Scene: not a scene file");
+    file.close();
+    return false;
+  }
+  if (header.numberOfUniverses != numberOfUniverses)
+  {
+    Serial.print("Scene: recorded with ");
+    Serial.print(header.numberOfUniverses);
+    Serial.println(" universes, does not match the configuration");
+    file.close();
+    return false;
+  }
+
+  recordSize = sceneRecordSize(numberOfUniverses);
+  frameMicros = header.frameMicros;
+  free(buffers[0]);
+  free(buffers[1]);
+  buffers[0] = (uint8_t *)malloc(recordSize);
+  buffers[1] = (uint8_t *)malloc(recordSize);
+  if (!buffers[0] || !buffers[1])
+  {
+    Serial.println("Scene: not enough memory");
+    file.close();
+    return false;
+  }
+  // A recording cut by a power loss still plays up to its last whole record
+  frameCount = (file.size() - SCENE_BLOCK) / recordSize;
+  return frameCount > 0;
+}
+
+void ScenePlayer::start(unsigned long now)
+{
+  if (!isOpen())
+    return;
+  file.seek(SCENE_BLOCK);
+  nextRecord = 0;
+  fill = 0;
+  lastMicros = 0;
+  loopOffset = 0;
+  startMicros = now;
+  playing = true;
+}
+
+void ScenePlayer::stop()
+{
+  playing = false;
+}
+
+bool ScenePlayer::update(unsigned long now)
+{
+  if (!playing)
+    return false;
+
+  uint8_t *back = buffers[front ^ 1];
+  if (fill < recordSize)
+  {
+    if (fill == 0 && nextRecord >= frameCount)
+    {
+      // Loop, one frame interval after the last frame
+      file.seek(SCENE_BLOCK);
+      nextRecord = 0;
+      loopOffset += lastMicros + frameMicros;
+    }
+
+    uint32_t size = min(recordSize - fill, (uint32_t)SCENE_READ_CHUNK);
+    if (file.read(back + fill, size) != size)
+    {
+      Serial.println("Scene: read error, playback stopped");
+      playing = false;
+      return false;
+    }
+    fill += size;
+    if (fill < recordSize)
+      return false;
+    nextRecord++;
+    lastMicros = ((const SceneRecord *)back)->micros;
+  }
+
+  // Whole record in memory, wait for its time
+  uint32_t due = loopOffset + lastMicros;
+  if ((int32_t)(now - startMicros - due) < 0)
+    return false;
+
+  front ^= 1;
+  fill = 0;
+  return true;
+}
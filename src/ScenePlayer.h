@@ -0,0 +1,75 @@
+/*
+ * @brief Stand-alone playback of a scene file from the SD card
+ *
+ * @details Two record buffers : the front one holds the frame on show, the
+ * back one is filled with the next record a slice at a time, so a call to
+ * update() never blocks the loop for more than one SCENE_READ_CHUNK read
+ * and the next frame is in memory before it is due. The scene loops.
+ *
+ */
+
+#ifndef SCENE_PLAYER_H
+#define SCENE_PLAYER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "SceneFile.h"
+
+// Bytes read from the card per update() call
+#define SCENE_READ_CHUNK 2048
+
+class ScenePlayer
+{
+public:
+  ScenePlayer();
+
+  // Check the header against the configuration and allocate the buffers.
+  // Return false when the file can not be played
+  bool open(const char *path, int numberOfUniverses);
+  void start(unsigned long now);
+  void stop();
+  // Read ahead. Return true when a new frame is due at now (in us)
+  bool update(unsigned long now);
+
+  // Frame returned by the last update()
+  inline const SceneRecord *getRecord(void)
+  {
+    return (const SceneRecord *)buffers[front];
+  }
+
+  inline const uint8_t *getUniverse(int index)
+  {
+    return buffers[front] + (index + 1) * SCENE_BLOCK;
+  }
+
+  inline bool isOpen(void)
+  {
+    return frameCount > 0;
+  }
+
+  inline bool isPlaying(void)
+  {
+    return playing;
+  }
+
+  inline uint32_t getFrameCount(void)
+  {
+    return frameCount;
+  }
+
+private:
+  File file;
+  uint8_t *buffers[2];
+  int front;
+  uint32_t fill; // bytes of the back buffer already read
+  uint32_t recordSize;
+  uint32_t frameCount;
+  uint32_t nextRecord;
+  uint32_t frameMicros;
+  uint32_t lastMicros;  // timestamp of the last record read
+  uint32_t loopOffset;  // duration of the previous loops
+  unsigned long startMicros;
+  bool playing;
+};
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * @brief Record the incoming universes to a scene file on the SD card
+ */
+
+#include "SceneRecorder.h"
+
+SceneRecorder::SceneRecorder()
+    : queue(nullptr), numberOfUniverses(0), recordSize(0), maxRecords(0), head(0), tail(0), count(0), written(0), frames(0), dropped(0), startMicros(0), lastMicros(0), recording(false), full(false)
+{
+}
+
+bool SceneRecorder::start(const char *path, int nbUniverses, uint64_t maxBytes)
+{
+  if (recording || nbUniverses > SCENE_MAX_UNIVERSES)
+    return false;
+
+  numberOfUniverses = nbUniverses;
+  recordSize = sceneRecordSize(nbUniverses);
+  maxRecords = (maxBytes - SCENE_BLOCK) / recordSize;
+  free(queue);
+  queue = (uint8_t *)malloc(SCENE_RECORD_QUEUE * recordSize);
+  if (!queue || maxRecords == 0)
+    return false;
+
+#if defined(ARDUINO)
+  file = SD.sdfs.open(path, O_RDWR | O_CREAT | O_TRUNC);
+#else
+  SD.remove(path);
+  file = SD.open(path, FILE_WRITE_BEGIN);
+#endif
+  if (!file)
+    return false;
+  if (!file.preAllocate(SCENE_BLOCK + maxRecords * recordSize))
+    Serial.println("Record: could not preallocate, writes may be slower");
+
+  // Header with no frame yet, completed by stop()
+  SceneHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SCENE_MAGIC, 4);
+  header.version = SCENE_VERSION;
+  header.numberOfUniverses = nbUniverses;
+  file.write(&header, sizeof(header));
+
+  head = 0;
+  tail = 0;
+  count = 0;
+  written = 0;
+  frames = 0;
+  dropped = 0;
+  lastMicros = 0;
+  clearRecord(head);
+  full = false;
+  recording = true;
+  return true;
+}
+
+void SceneRecorder::clearRecord(int slot)
+{
+  memset(getRecord(slot), 0, SCENE_BLOCK);
+}
+
+void SceneRecorder::addUniverse(int index, const uint8_t *data, uint16_t length)
+{
+  if (!recording || index < 0 || index >= numberOfUniverses)
+    return;
+  if (length > SCENE_BLOCK)
+    length = SCENE_BLOCK;
+  memcpy(queue + head * recordSize + (index + 1) * SCENE_BLOCK, data, length);
+  getRecord(head)->length[index] = length;
+}
+
+void SceneRecorder::endFrame(unsigned long now)
+{
+  if (!recording || full)
+    return;
+
+  // stop() writes the queue and closes the file : too long for a DMX callback
+  if (frames + count >= maxRecords)
+  {
+    Serial.println("Record: file full");
+    full = true;
+    return;
+  }
+  // Card too slow : the assembled frame is overwritten by the next one
+  if (count >= SCENE_RECORD_QUEUE - 1)
+  {
+    dropped++;
+    clearRecord(head);
+    return;
+  }
+
+  SceneRecord *record = getRecord(head);
+  if (frames + count == 0)
+    startMicros = now;
+  record->micros = now - startMicros;
+  record->frame = frames + count;
+  lastMicros = record->micros;
+
+  count++;
+  head = (head + 1) % SCENE_RECORD_QUEUE;
+  clearRecord(head);
+}
+
+void SceneRecorder::update()
+{
+  if (!recording || count == 0)
+    return;
+
+  // Whole blocks from a block aligned position : the card is written without the sector cache
+  uint32_t size = min(recordSize - written, (uint32_t)SCENE_WRITE_CHUNK);
+  if (file.write(queue + tail * recordSize + written, size) != size)
+  {
+    Serial.println("Record: write error");
+    recording = false;
+    file.close();
+    return;
+  }
+  written += size;
+  if (written < recordSize)
+    return;
+
+  written = 0;
+  tail = (tail + 1) % SCENE_RECORD_QUEUE;
+  count--;
+  frames++;
+}
+
+void SceneRecorder::stop()
+{
+  if (!recording)
+    return;
+  while (count > 0 && recording)
+    update();
+  if (!recording)
+    return;
+  recording = false;
+
+  SceneHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SCENE_MAGIC, 4);
+  header.version = SCENE_VERSION;
+  header.numberOfUniverses = numberOfUniverses;
+  header.frameCount = frames;
+  header.frameMicros = frames > 1 ? lastMicros / (frames - 1) : 0;
+  file.seek(0);
+  file.write(&header, sizeof(header));
+  // Give back the preallocated space that was not used
+  file.truncate(SCENE_BLOCK + (uint64_t)frames * recordSize);
+  file.close();
+}
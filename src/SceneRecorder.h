@@ -0,0 +1,95 @@
+/*
+ * @brief Record the incoming universes to a scene file on the SD card
+ *
+ * @details The DMX callbacks copy each universe into the record being
+ * assembled, a slot of a small queue. When the frame is complete the slot
+ * is queued and update(), called from loop() when no packet is waiting,
+ * writes it a slice of whole blocks at a time. The file is preallocated
+ * so the card never has to look for free clusters during a show. When the
+ * queue is full the frame is dropped rather than stalling the reception.
+ *
+ */
+
+#ifndef SCENE_RECORDER_H
+#define SCENE_RECORDER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "SceneFile.h"
+
+// Frames waiting for the card, the one being assembled included
+#define SCENE_RECORD_QUEUE 3
+// Bytes written to the card per update() call
+#define SCENE_WRITE_CHUNK 4096
+
+#if defined(ARDUINO)
+// SdFat file of the Teensy SD library : it can preallocate contiguous clusters
+typedef FsFile SceneFileHandle;
+#else
+typedef File SceneFileHandle;
+#endif
+
+class SceneRecorder
+{
+public:
+  SceneRecorder();
+
+  // Create path (replaced if it exists) with room for maxBytes
+  bool start(const char *path, int numberOfUniverses, uint64_t maxBytes);
+  // Write what is queued, update the header and give back the unused space
+  void stop();
+  // Levels of one universe of the frame being assembled
+  void addUniverse(int index, const uint8_t *data, uint16_t length);
+  // The frame is complete, queue it. now is in us. Once the file is full the
+  // frames are dropped and isFull() tells loop() to stop()
+  void endFrame(unsigned long now);
+  // Write one slice of the queue
+  void update();
+
+  inline bool isRecording(void)
+  {
+    return recording;
+  }
+
+  // No room left in the file : stop() must be called, outside of the DMX callbacks
+  inline bool isFull(void)
+  {
+    return full;
+  }
+
+  inline uint32_t getFrames(void)
+  {
+    return frames;
+  }
+
+  // Frames lost because the card was too slow
+  inline uint32_t getDropped(void)
+  {
+    return dropped;
+  }
+
+private:
+  SceneFileHandle file;
+  uint8_t *queue; // SCENE_RECORD_QUEUE records
+  int numberOfUniverses;
+  uint32_t recordSize;
+  uint64_t maxRecords;
+  int head;  // record being assembled
+  int tail;  // next record to write
+  int count; // records complete and waiting
+  uint32_t written; // bytes of the tail record already on the card
+  uint32_t frames;  // records on the card or queued
+  uint32_t dropped;
+  unsigned long startMicros;
+  uint32_t lastMicros;
+  bool recording;
+  bool full;
+
+  inline SceneRecord *getRecord(int slot)
+  {
+    return (SceneRecord *)(queue + slot * recordSize);
+  }
+  void clearRecord(int slot);
+};
+
+#endif
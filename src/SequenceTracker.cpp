@@ -0,0 +1,71 @@
+/*
+ * @brief Art-Net sequence number check, per universe
+ */
+
+#include "SequenceTracker.h"
+
+SequenceTracker::SequenceTracker() : states(nullptr), numberOfUniverses(0), ringSize(255), lost(0), dropped(0) {}
+
+void SequenceTracker::begin(int n, bool e131)
+{
+  numberOfUniverses = n;
+  ringSize = e131 ? 256 : 255;
+  free(states);
+  states = (UniverseSequence *)calloc(n, sizeof(UniverseSequence));
+  lost = 0;
+  dropped = 0;
+}
+
+bool SequenceTracker::accept(int index, uint8_t sequence)
+{
+  if (index < 0 || index >= numberOfUniverses)
+    return true;
+
+  UniverseSequence &state = states[index];
+
+  // Sequence disabled by the Art-Net sender
+  if (sequence == 0 && ringSize == 255)
+  {
+    state.seen = false;
+    return true;
+  }
+
+  // First packet of this universe
+  if (!state.seen)
+  {
+    state.last = sequence;
+    state.seen = true;
+    state.lateCount = 0;
+    return true;
+  }
+
+  // Distance on the ring, 1..255 for Art-Net where 0 is not part of it
+  int distance = (int)sequence - (int)state.last;
+  if (distance < 0)
+    distance += ringSize;
+
+  if (distance == 0 || distance > 127)
+  {
+    if (++state.lateCount < SEQUENCE_RESYNC_COUNT)
+    {
+      dropped++;
+      return false;
+    }
+    // The sender restarted, follow it
+    distance = 1;
+  }
+
+  state.lost += distance - 1;
+  lost += distance - 1;
+  state.last = sequence;
+  state.lateCount = 0;
+  return true;
+}
+
+void SequenceTracker::resetCounters()
+{
+  lost = 0;
+  dropped = 0;
+  for (int i = 0; i < numberOfUniverses; i++)
+    states[i].lost = 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * @brief Art-Net sequence number check, per universe
+ *
+ * @details The sequence goes 0x01 .. 0xFF then wraps to 0x01, 0x00 means the
+ * sender does not use it. A packet more than half a turn behind the last
+ * accepted one is late (it belongs to an older frame) and is dropped, a jump
+ * forward counts the packets lost in between. After a few late packets in a
+ * row the sender is assumed to have restarted and the tracker resyncs.
+ * sACN (E1.31) uses the same rules on a 0x00 .. 0xFF ring, 0 being valid.
+ *
+ */
+
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include <Arduino.h>
+
+// Consecutive late packets on a universe before following the new sequence
+#define SEQUENCE_RESYNC_COUNT 8
+
+class SequenceTracker
+{
+public:
+  SequenceTracker();
+
+  void begin(int numberOfUniverses, bool e131 = false);
+  // Return false when the packet is late or a duplicate and must be ignored.
+  // index is the universe minus startuniverse
+  bool accept(int index, uint8_t sequence);
+  // A new sender on index : its first packet is accepted whatever its sequence
+  inline void restart(int index)
+  {
+    if (index >= 0 && index < numberOfUniverses)
+      states[index].seen = false;
+  }
+  void resetCounters();
+
+  // Packets missing in the sequence, all universes
+  inline uint32_t getLost(void)
+  {
+    return lost;
+  }
+
+  // Late or duplicate packets ignored, all universes
+  inline uint32_t getDropped(void)
+  {
+    return dropped;
+  }
+
+  inline uint32_t getLost(int index)
+  {
+    return states[index].lost;
+  }
+
+private:
+  struct UniverseSequence
+  {
+    uint8_t last;
+    bool seen; // false until the first packet with a sequence
+    uint8_t lateCount;
+    uint32_t lost;
+  };
+
+  UniverseSequence *states;
+  int numberOfUniverses;
+  int ringSize; // 255 for Art-Net, 256 for sACN
+  uint32_t lost;
+  uint32_t dropped;
+};
+
+#endif
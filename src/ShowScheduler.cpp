@@ -0,0 +1,14 @@
+/*
+ * @brief When can the next frame be clocked out to the strips
+ */
+
+#include "ShowScheduler.h"
+
+ShowScheduler::ShowScheduler() : frameMicros(0), pending(false) {}
+
+void ShowScheduler::begin(int ledsPerStrip, int bytesPerLed, uint32_t bitNanos)
+{
+  uint64_t bits = (uint64_t)ledsPerStrip * bytesPerLed * 8;
+  frameMicros = (uint32_t)(bits * bitNanos / 1000) + SHOW_LATCH_MICROS;
+  pending = false;
+}
@@ -0,0 +1,55 @@
+/*
+ * @brief When can the next frame be clocked out to the strips
+ *
+ * @details OctoWS2811 drives all the strips in parallel, so one frame takes
+ * the wire time of a single strip : ledsperstrip * bytes per led * 8 bits
+ * at 1.25 us (800 kHz), plus the latch time. The scheduler keeps that
+ * estimate and a pending flag so the DMX callbacks never wait for the bus :
+ * a frame that can not start now is pushed from loop() once it is free.
+ *
+ */
+
+#ifndef SHOW_SCHEDULER_H
+#define SHOW_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SHOW_BIT_NANOS_800KHZ 1250
+#define SHOW_BIT_NANOS_400KHZ 2500
+#define SHOW_LATCH_MICROS 300
+
+class ShowScheduler
+{
+public:
+  ShowScheduler();
+
+  void begin(int ledsPerStrip, int bytesPerLed, uint32_t bitNanos);
+
+  // Wire time of one frame, latch included, in us
+  inline uint32_t getFrameMicros(void)
+  {
+    return frameMicros;
+  }
+
+  // Highest frame rate the strips can take, in frames per second
+  inline uint32_t getMaxFrameRate(void)
+  {
+    return frameMicros ? 1000000UL / frameMicros : 0;
+  }
+
+  inline bool isPending(void)
+  {
+    return pending;
+  }
+
+  inline void setPending(bool p)
+  {
+    pending = p;
+  }
+
+private:
+  uint32_t frameMicros;
+  bool pending;
+};
+
+#endif
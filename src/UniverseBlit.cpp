@@ -0,0 +1,77 @@
+/*
+ * @brief Copy of one received universe into the led buffer
+ */
+
+#include "UniverseBlit.h"
+#include "PixelBlit.h"
+
+UniverseBlit::UniverseBlit() : universes(nullptr), pixels(nullptr), power(nullptr) {}
+
+void UniverseBlit::begin(UniverseMap *u, PixelMap *p, PowerLimiter *pw)
+{
+  universes = u;
+  pixels = p;
+  power = pw;
+}
+
+// Part of a pixel split between two universes, placed by the pixel map
+void UniverseBlit::blitSplitPixel(uint8_t *drawing, int index, uint32_t pixel, int first, const uint8_t *data, int count, const ColorLut *lut, const ColorLut *powerLut)
+{
+  int r = pixels->findRun(pixel);
+  if (r < 0)
+    return;
+  const PixelRun &run = pixels->getRun(r);
+  uint32_t sum = blitComponents(drawing, pixels->getPhysical(run, pixel), first, data, count, run.order, lut);
+  if (powerLut && power->isEnabled())
+    sum = sumThroughLut(data, first, count, pixelChannels(run.order), powerLut);
+  power->add(index, run.strip, sum);
+}
+
+void UniverseBlit::blit(uint8_t *drawing, int index, const uint8_t *data, int length, const ColorLut *lut, const ColorLut *powerLut)
+{
+  // it can be receiving universe=1 with startUniverse at 7
+  const UniverseMapEntry *entry = universes->get(index);
+  if (entry == nullptr)
+    return;
+
+  int channels = universes->getChannelsPerPixel();
+  // The channel sums of the copy feed the power budget, per strip
+  power->clearUniverse(index);
+
+  // end of the pixel started by the previous universe
+  if (entry->headChannels && entry->firstPixel > 0)
+    blitSplitPixel(drawing, index, entry->firstPixel - 1, channels - entry->headChannels, data, min((int)entry->headChannels, length), lut, powerLut);
+
+  int count = (length - entry->channelOffset) / channels;
+  if (count > entry->pixelCount)
+    count = entry->pixelCount;
+
+  // whole pixels, one run of consecutive leds at a time : a strip, or a line of a serpentine strip
+  uint32_t pixel = entry->firstPixel;
+  const uint8_t *src = data + entry->channelOffset;
+  int r = pixels->findRun(pixel);
+  while (count > 0 && r >= 0 && r < pixels->getNumberOfRuns())
+  {
+    const PixelRun &run = pixels->getRun(r);
+    int n = min(count, (int)(run.first + run.count - pixel));
+    uint32_t physical = pixels->getPhysical(run, pixel);
+    uint32_t sum;
+    if (run.step > 0)
+      sum = blitPixels(drawing, physical, src, n, run.order, lut);
+    else
+      sum = blitPixelsReverse(drawing, physical, src, n, run.order, lut);
+    // the current comes from the levels after the tables, whoever applies them
+    if (powerLut && power->isEnabled())
+      sum = sumThroughLut(src, 0, n * channels, channels, powerLut);
+    power->add(index, run.strip, sum);
+    pixel += n;
+    src += n * channels;
+    count -= n;
+    r++;
+  }
+
+  // start of the pixel finished by the next universe
+  int tail = entry->channelOffset + entry->pixelCount * channels;
+  if (entry->tailChannels && length >= tail + entry->tailChannels)
+    blitSplitPixel(drawing, index, entry->firstPixel + entry->pixelCount, 0, data + tail, entry->tailChannels, lut, powerLut);
+}
@@ -0,0 +1,39 @@
+/*
+ * @brief Copy of one received universe into the led buffer
+ *
+ * @details UniverseMap gives the pixels a universe carries, PixelMap where
+ * they land on the strips : the copy is one bulk blit per run of
+ * consecutive leds, plus the pixels split with the neighbour universes.
+ * The channel sums go to the power budget on the way. Shared by the
+ * firmware and the workstation build, so both produce the same bytes.
+ *
+ */
+
+#ifndef UNIVERSE_BLIT_H
+#define UNIVERSE_BLIT_H
+
+#include <Arduino.h>
+#include "UniverseMap.h"
+#include "PixelMap.h"
+#include "PowerLimiter.h"
+#include "ColorLut.h"
+
+class UniverseBlit
+{
+public:
+  UniverseBlit();
+
+  void begin(UniverseMap *universes, PixelMap *pixels, PowerLimiter *power);
+  // Copy the DMX data of universe index (0 is startuniverse) into drawing, lut may be nullptr.
+  // powerLut : tables applied later (dither), the power sums go through them. Universes outside of the map are dropped
+  void blit(uint8_t *drawing, int index, const uint8_t *data, int length, const ColorLut *lut, const ColorLut *powerLut = nullptr);
+
+private:
+  UniverseMap *universes;
+  PixelMap *pixels;
+  PowerLimiter *power;
+
+  void blitSplitPixel(uint8_t *drawing, int index, uint32_t pixel, int first, const uint8_t *data, int count, const ColorLut *lut, const ColorLut *powerLut);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * @brief Where the channels of each universe land in the led buffer
+ */
+
+#include "UniverseMap.h"
+
+UniverseMap::UniverseMap() : entries(nullptr), numberOfUniverses(0), channelsPerPixel(3) {}
+
+void UniverseMap::begin(int numberOfLeds, int cpp, bool align)
+{
+  channelsPerPixel = cpp;
+  int numberOfChannels = numberOfLeds * channelsPerPixel;
+  int pixelsPerUniverse = DMX_CHANNELS_PER_UNIVERSE / channelsPerPixel;
+
+  if (align)
+    numberOfUniverses = numberOfLeds / pixelsPerUniverse + ((numberOfLeds % pixelsPerUniverse) ? 1 : 0);
+  else
+    numberOfUniverses = numberOfChannels / DMX_CHANNELS_PER_UNIVERSE + ((numberOfChannels % DMX_CHANNELS_PER_UNIVERSE) ? 1 : 0);
+
+  free(entries);
+  entries = (UniverseMapEntry *)calloc(numberOfUniverses, sizeof(UniverseMapEntry));
+
+  for (int u = 0; u < numberOfUniverses; u++)
+  {
+    UniverseMapEntry &entry = entries[u];
+
+    if (align)
+    {
+      entry.firstPixel = u * pixelsPerUniverse;
+      int remaining = numberOfLeds - entry.firstPixel;
+      entry.pixelCount = remaining < pixelsPerUniverse ? remaining : pixelsPerUniverse;
+      continue;
+    }
+
+    // Channels [first, last) of the whole led stream are carried by this universe
+    int first = u * DMX_CHANNELS_PER_UNIVERSE;
+    int last = first + DMX_CHANNELS_PER_UNIVERSE;
+    if (last > numberOfChannels)
+      last = numberOfChannels;
+
+    int head = (channelsPerPixel - first % channelsPerPixel) % channelsPerPixel;
+    if (head > last - first)
+      head = last - first;
+    entry.headChannels = head;
+    entry.channelOffset = head;
+    entry.firstPixel = (first + head) / channelsPerPixel;
+    entry.pixelCount = (last - first - head) / channelsPerPixel;
+    entry.tailChannels = (last - first - head) % channelsPerPixel;
+  }
+}
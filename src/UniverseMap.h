@@ -0,0 +1,61 @@
+/*
+ * @brief Where the channels of each universe land in the led buffer
+ *
+ * @details Built once by loadConfiguration. Two packings are supported :
+ * - aligned : every universe starts on a new pixel, 170 RGB pixels per
+ *   universe, the last 2 channels are unused (MadMapper default)
+ * - continuous : the pixels are packed over 512 channels universes, a
+ *   pixel can start at the end of a universe and finish in the next one
+ * The DMX callbacks only do a table lookup, whatever the arrival order
+ * or the length of the previous packet.
+ *
+ */
+
+#ifndef UNIVERSE_MAP_H
+#define UNIVERSE_MAP_H
+
+#include <Arduino.h>
+
+#define DMX_CHANNELS_PER_UNIVERSE 512
+
+struct UniverseMapEntry
+{
+  uint32_t firstPixel;    // led receiving the first whole pixel of the universe
+  uint16_t pixelCount;    // whole pixels carried by the universe
+  uint16_t channelOffset; // channel (0 based) of that first whole pixel
+  uint8_t headChannels;   // channels before channelOffset, they finish pixel firstPixel - 1
+  uint8_t tailChannels;   // channels after the last whole pixel, they start the next pixel
+};
+
+class UniverseMap
+{
+public:
+  UniverseMap();
+
+  void begin(int numberOfLeds, int channelsPerPixel, bool align);
+
+  // index is the universe minus startuniverse. nullptr when out of the map
+  inline const UniverseMapEntry *get(int index)
+  {
+    if (index < 0 || index >= numberOfUniverses)
+      return nullptr;
+    return &entries[index];
+  }
+
+  inline int getNumberOfUniverses(void)
+  {
+    return numberOfUniverses;
+  }
+
+  inline int getChannelsPerPixel(void)
+  {
+    return channelsPerPixel;
+  }
+
+private:
+  UniverseMapEntry *entries;
+  int numberOfUniverses;
+  int channelsPerPixel;
+};
+
+#endif
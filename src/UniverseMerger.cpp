@@ -0,0 +1,106 @@
+/*
+ * @brief Art-Net merge of two senders on the same universe
+ */
+
+#include "UniverseMerger.h"
+
+UniverseMerger::UniverseMerger() : sources(nullptr), levels(nullptr), numberOfUniverses(0), mode(MERGE_OFF), rejected(0) {}
+
+void UniverseMerger::begin(int n, uint8_t m)
+{
+  numberOfUniverses = n;
+  mode = m;
+  rejected = 0;
+  free(sources);
+  free(levels);
+  sources = nullptr;
+  levels = nullptr;
+  if (mode == MERGE_OFF)
+    return;
+  sources = (UniverseSources *)calloc(n, sizeof(UniverseSources));
+  if (mode == MERGE_HTP)
+    levels = (uint8_t *)calloc(n * MERGE_SOURCES, MERGE_CHANNELS);
+}
+
+int UniverseMerger::source(int index, IPAddress ip, unsigned long now, bool &assigned)
+{
+  assigned = false;
+  if (mode == MERGE_OFF || index < 0 || index >= numberOfUniverses)
+    return 0;
+
+  UniverseSources &u = sources[index];
+  uint32_t address = ip;
+  // Forget the senders that went silent, whoever is sending now
+  for (int s = 0; s < MERGE_SOURCES; s++)
+  {
+    if (u.ip[s] && now - u.last[s] > MERGE_TIMEOUT_MS)
+      u.ip[s] = 0;
+  }
+
+  int freeSlot = -1;
+  for (int s = 0; s < MERGE_SOURCES; s++)
+  {
+    if (u.ip[s] == address)
+    {
+      u.last[s] = now;
+      return s;
+    }
+    if (!u.ip[s] && freeSlot < 0)
+      freeSlot = s;
+  }
+
+  if (freeSlot < 0)
+  {
+    rejected++;
+    return -1;
+  }
+  u.ip[freeSlot] = address;
+  u.last[freeSlot] = now;
+  u.length[freeSlot] = 0;
+  assigned = true;
+  return freeSlot;
+}
+
+const uint8_t *UniverseMerger::merge(int index, int slot, const uint8_t *data, uint16_t &length, unsigned long now)
+{
+  if (mode != MERGE_HTP || index < 0 || index >= numberOfUniverses)
+    return data;
+
+  UniverseSources &u = sources[index];
+  if (length > MERGE_CHANNELS)
+    length = MERGE_CHANNELS;
+  uint8_t *own = levels + (index * MERGE_SOURCES + slot) * MERGE_CHANNELS;
+  int other = slot ^ 1;
+
+  // Alone on the universe, or the other sender went silent : keep the levels
+  // for a later merge, send them as is
+  if (!u.ip[other] || now - u.last[other] > MERGE_TIMEOUT_MS)
+  {
+    memcpy(own, data, length);
+    u.length[slot] = length;
+    return data;
+  }
+
+  const uint8_t *otherLevels = levels + (index * MERGE_SOURCES + other) * MERGE_CHANNELS;
+  uint16_t otherLength = u.length[other];
+  uint16_t common = min(length, otherLength);
+  for (uint16_t i = 0; i < common; i++)
+  {
+    uint8_t v = data[i];
+    uint8_t o = otherLevels[i];
+    own[i] = v;
+    merged[i] = v > o ? v : o;
+  }
+  // Channels only one of the two senders sends
+  if (length > common)
+  {
+    memcpy(own + common, data + common, length - common);
+    memcpy(merged + common, data + common, length - common);
+  }
+  else if (otherLength > common)
+    memcpy(merged + common, otherLevels + common, otherLength - common);
+
+  u.length[slot] = length;
+  length = max(length, otherLength);
+  return merged;
+}
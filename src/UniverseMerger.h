@@ -0,0 +1,78 @@
+/*
+ * @brief Art-Net merge of two senders on the same universe
+ *
+ * @details Each universe accepts up to MERGE_SOURCES senders, identified by
+ * their IP. A sender that has been silent for MERGE_TIMEOUT_MS frees its
+ * place, a third sender is ignored meanwhile. In LTP mode the last packet
+ * wins and is used as is. In HTP mode the last levels of each sender are
+ * kept, and the highest of the two is computed while the incoming packet
+ * is stored : the result is read once more by the pixel blit, while it is
+ * still in cache. The merge is not done inside the blit : the store is
+ * needed anyway for the next packet of the other sender, the scene recorder
+ * takes the merged levels, and the blit keeps one copy per color order.
+ *
+ */
+
+#ifndef UNIVERSE_MERGER_H
+#define UNIVERSE_MERGER_H
+
+#include <Arduino.h>
+
+#define MERGE_SOURCES 2
+// Art-Net spec : a source that stops sending leaves the merge after 10 s
+#define MERGE_TIMEOUT_MS 10000
+#define MERGE_CHANNELS 512
+
+enum MergeMode
+{
+  MERGE_OFF, // every packet is used, whatever its sender
+  MERGE_HTP, // highest takes precedence, channel per channel
+  MERGE_LTP, // latest takes precedence, whole universe
+};
+
+class UniverseMerger
+{
+public:
+  UniverseMerger();
+
+  void begin(int numberOfUniverses, uint8_t mode);
+  // Slot of the sender on universe index, -1 when two other senders own it.
+  // Always 0 when merging is off. assigned is set when the slot has just been
+  // given to this sender : its sequence starts over
+  int source(int index, IPAddress ip, unsigned long now, bool &assigned);
+  // Levels to send to the leds after a packet from slot. length becomes the merged length
+  const uint8_t *merge(int index, int slot, const uint8_t *data, uint16_t &length, unsigned long now);
+
+  inline uint8_t getMode(void)
+  {
+    return mode;
+  }
+
+  // Packets ignored because the universe already had two senders
+  inline uint32_t getRejected(void)
+  {
+    return rejected;
+  }
+
+  inline void resetCounters(void)
+  {
+    rejected = 0;
+  }
+
+private:
+  struct UniverseSources
+  {
+    uint32_t ip[MERGE_SOURCES]; // 0 when the slot is free
+    unsigned long last[MERGE_SOURCES];
+    uint16_t length[MERGE_SOURCES];
+  };
+
+  UniverseSources *sources;
+  uint8_t *levels; // HTP : last levels of each slot, [universe][slot][channel]
+  uint8_t merged[MERGE_CHANNELS];
+  int numberOfUniverses;
+  uint8_t mode;
+  uint32_t rejected;
+};
+
+#endif
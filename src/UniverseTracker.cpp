@@ -0,0 +1,47 @@
+/*
+ * @brief Which universes of the current frame have been received
+ */
+
+#include "UniverseTracker.h"
+
+UniverseTracker::UniverseTracker() : received(nullptr), words(0), numberOfUniverses(0), receivedCount(0) {}
+
+void UniverseTracker::begin(int n)
+{
+  numberOfUniverses = n;
+  words = (n + 31) / 32;
+  received = (uint32_t *)malloc(words * sizeof(uint32_t));
+  reset();
+}
+
+bool UniverseTracker::mark(int index)
+{
+  if (index < 0 || index >= numberOfUniverses)
+    return isComplete();
+
+  uint32_t bit = 1UL << (index & 31);
+  uint32_t &word = received[index >> 5];
+  if (!(word & bit))
+  {
+    word |= bit;
+    receivedCount++;
+  }
+  return isComplete();
+}
+
+void UniverseTracker::reset()
+{
+  memset(received, 0, words * sizeof(uint32_t));
+  receivedCount = 0;
+}
+
+int UniverseTracker::getMissing(uint16_t *list, int maxCount)
+{
+  int count = 0;
+  for (int i = 0; i < numberOfUniverses && count < maxCount; i++)
+  {
+    if (!isReceived(i))
+      list[count++] = i;
+  }
+  return count;
+}
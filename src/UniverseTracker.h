@@ -0,0 +1,55 @@
+/*
+ * @brief Which universes of the current frame have been received
+ *
+ * @details One bit per universe plus a counter of the bits set, so marking
+ * a universe and checking that the frame is complete are both constant
+ * time whatever numberofuniverses is.
+ *
+ */
+
+#ifndef UNIVERSE_TRACKER_H
+#define UNIVERSE_TRACKER_H
+
+#include <Arduino.h>
+
+class UniverseTracker
+{
+public:
+  UniverseTracker();
+
+  void begin(int numberOfUniverses);
+  // Set the bit of universe index (0 is startuniverse). Return true if the frame is now complete
+  bool mark(int index);
+  // Forget everything, to be called once the frame has been shown
+  void reset();
+  // Fill list with the indexes still missing, return how many there are
+  int getMissing(uint16_t *list, int maxCount);
+
+  inline bool isComplete(void)
+  {
+    return receivedCount == numberOfUniverses;
+  }
+
+  inline bool isReceived(int index)
+  {
+    return received[index >> 5] & (1UL << (index & 31));
+  }
+
+  inline int getReceivedCount(void)
+  {
+    return receivedCount;
+  }
+
+  inline int getMissingCount(void)
+  {
+    return numberOfUniverses - receivedCount;
+  }
+
+private:
+  uint32_t *received;
+  int words;
+  int numberOfUniverses;
+  int receivedCount;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * @brief Minimal Arduino core for the native (Linux) build
+ *
+ * @details Only what the shared sources use : integer types, time, Serial,
+ * String and IPAddress. Selected by the [env:native] include path, never
+ * seen by the Teensy build.
+ *
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define DEC 10
+#define HEX 16
+#define F(s) (s)
+#define DMAMEM
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+template <class A, class B>
+inline A min(A a, B b) { return a < (A)b ? a : (A)b; }
+template <class A, class B>
+inline A max(A a, B b) { return a > (A)b ? a : (A)b; }
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+class IPAddress
+{
+public:
+  IPAddress() { address.dword = 0; }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    address.bytes[0] = a;
+    address.bytes[1] = b;
+    address.bytes[2] = c;
+    address.bytes[3] = d;
+  }
+  IPAddress(uint32_t dword) { address.dword = dword; }
+  IPAddress(const uint8_t *bytes) { memcpy(address.bytes, bytes, 4); }
+
+  // Same memory layout as the Arduino core : bytes[0] is the first octet
+  operator uint32_t() const { return address.dword; }
+  bool operator==(const IPAddress &other) const { return address.dword == other.address.dword; }
+  bool operator!=(const IPAddress &other) const { return address.dword != other.address.dword; }
+  uint8_t operator[](int index) const { return address.bytes[index]; }
+  uint8_t &operator[](int index) { return address.bytes[index]; }
+  IPAddress &operator=(const uint8_t *bytes)
+  {
+    memcpy(address.bytes, bytes, 4);
+    return *this;
+  }
+  IPAddress &operator=(uint32_t dword)
+  {
+    address.dword = dword;
+    return *this;
+  }
+
+private:
+  union
+  {
+    uint8_t bytes[4];
+    uint32_t dword;
+  } address;
+};
+
+class String
+{
+public:
+  String() {}
+  String(const char *s) : str(s) {}
+  unsigned int length() const { return str.length(); }
+  const char *c_str() const { return str.c_str(); }
+  void toCharArray(char *buf, unsigned int bufsize) const
+  {
+    if (bufsize == 0)
+      return;
+    strncpy(buf, str.c_str(), bufsize - 1);
+    buf[bufsize - 1] = 0;
+  }
+
+private:
+  std::string str;
+};
+
+class HostSerial
+{
+public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  int available() { return 0; }
+  int read() { return -1; }
+
+  void print(const char *s) { fputs(s, stdout); }
+  void print(const String &s) { fputs(s.c_str(), stdout); }
+  void print(char c) { fputc(c, stdout); }
+  void print(long n, int base = DEC) { printf(base == HEX ? "%lX" : "%ld", n); }
+  void print(unsigned long n, int base = DEC) { printf(base == HEX ? "%lX" : "%lu", n); }
+  void print(int n, int base = DEC) { print((long)n, base); }
+  void print(unsigned int n, int base = DEC) { print((unsigned long)n, base); }
+  void print(double n, int digits = 2) { printf("%.*f", digits, n); }
+  void print(const IPAddress &ip) { printf("%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]); }
+
+  void println() { fputc('\n', stdout); }
+  template <typename T>
+  void println(const T &value)
+  {
+    print(value);
+    println();
+  }
+  template <typename T>
+  void println(const T &value, int format)
+  {
+    print(value, format);
+    println();
+  }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * @brief PixelOutput that records the frames instead of lighting leds (Linux)
+ */
+
+#include "FramePixelOutput.h"
+#include "../PixelBlit.h"
+#include "../ConfigCache.h"
+
+FramePixelOutput::FramePixelOutput()
+    : drawing(nullptr), size(0), numberOfStrips(0), ledsPerStrip(0), channels(3), log(nullptr), ppmPattern(nullptr), frames(0), lastCrc(0), lastMicros(0)
+{
+}
+
+FramePixelOutput::~FramePixelOutput()
+{
+  if (log && log != stdout)
+    fclose(log);
+  free(drawing);
+}
+
+void FramePixelOutput::setLayout(int strips, int leds, const uint8_t *o)
+{
+  numberOfStrips = min(strips, (int)sizeof(orders));
+  ledsPerStrip = leds;
+  memcpy(orders, o, numberOfStrips);
+  channels = pixelChannels(orders[0]);
+  size = (size_t)numberOfStrips * ledsPerStrip * channels;
+  free(drawing);
+  drawing = (uint8_t *)calloc(size, 1);
+}
+
+bool FramePixelOutput::setLog(const char *path)
+{
+  if (log && log != stdout)
+    fclose(log);
+  log = nullptr;
+  if (path == nullptr)
+    return true;
+  log = strcmp(path, "-") ? fopen(path, "w") : stdout;
+  return log != nullptr;
+}
+
+void FramePixelOutput::setPpmPattern(const char *pattern)
+{
+  ppmPattern = pattern;
+}
+
+void FramePixelOutput::begin()
+{
+  frames = 0;
+}
+
+void FramePixelOutput::show()
+{
+  lastMicros = micros();
+  lastCrc = crc32(drawing, size);
+  if (log)
+  {
+    fprintf(log, "%lu %lu %08lx\n", (unsigned long)frames, lastMicros, (unsigned long)lastCrc);
+    fflush(log);
+  }
+  if (ppmPattern)
+    writePpm();
+  frames++;
+}
+
+void FramePixelOutput::setPixel(uint32_t num, uint8_t red, uint8_t green, uint8_t blue)
+{
+  if (num >= (uint32_t)(numberOfStrips * ledsPerStrip))
+    return;
+  uint8_t rgb[4] = {red, green, blue, 0};
+  blitPixels(drawing, num, rgb, 1, orders[num / ledsPerStrip]);
+}
+
+void FramePixelOutput::writePpm()
+{
+  char path[256];
+  snprintf(path, sizeof(path), ppmPattern, (unsigned long)frames);
+  FILE *f = fopen(path, "wb");
+  if (f == nullptr)
+    return;
+
+  fprintf(f, "P6\n%d %d\n255\n", ledsPerStrip, numberOfStrips);
+  const uint8_t *led = drawing;
+  for (int s = 0; s < numberOfStrips; s++)
+  {
+    const uint8_t *colors = wireColor[orders[s] & PIXEL_ORDER_MASK];
+    for (int i = 0; i < ledsPerStrip; i++)
+    {
+      uint8_t rgb[3];
+      int white = channels == 4 ? led[3] : 0;
+      for (int c = 0; c < 3; c++)
+        rgb[colors[c]] = min(led[c] + white, 255);
+      fwrite(rgb, 1, 3, f);
+      led += channels;
+    }
+  }
+  fclose(f);
+}
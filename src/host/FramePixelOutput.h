@@ -0,0 +1,77 @@
+/*
+ * @brief PixelOutput that records the frames instead of lighting leds (Linux)
+ *
+ * @details Same drawing memory layout as OctoWS2811 : bytes in wire order,
+ * ledsPerStrip leds per strip, strip after strip. Each show() adds a line
+ * "frame micros crc32" to the log, and can also write the frame as a PPM
+ * image (one row per strip, colors back in RGB order, white added to the
+ * colors for RGBW), so the pixel path can be checked byte for byte and in
+ * time on a workstation.
+ *
+ */
+
+#ifndef FRAME_PIXEL_OUTPUT_H
+#define FRAME_PIXEL_OUTPUT_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "../PixelOutput.h"
+
+class FramePixelOutput : public PixelOutput
+{
+public:
+  FramePixelOutput();
+  ~FramePixelOutput();
+
+  // One PixelOrder per strip, PIXEL_W on all of them for RGBW
+  void setLayout(int numberOfStrips, int ledsPerStrip, const uint8_t *orders);
+  // "-" is stdout, nullptr keeps no log. Return false when the file can not be created
+  bool setLog(const char *path);
+  // Write frame n to printf(pattern, n), "frames/%06lu.ppm" for example. nullptr stops the dumps
+  void setPpmPattern(const char *pattern);
+
+  void begin();
+  void show();
+  int busy() { return 0; }
+  // Led num of the whole buffer, in the order of its strip
+  void setPixel(uint32_t num, uint8_t red, uint8_t green, uint8_t blue);
+  uint8_t *getDrawingMemory() { return drawing; }
+
+  inline uint32_t getFrames(void)
+  {
+    return frames;
+  }
+
+  // Of the last shown frame
+  inline uint32_t getLastCrc(void)
+  {
+    return lastCrc;
+  }
+
+  inline unsigned long getLastMicros(void)
+  {
+    return lastMicros;
+  }
+
+  inline size_t getSize(void)
+  {
+    return size;
+  }
+
+private:
+  uint8_t *drawing;
+  size_t size;
+  int numberOfStrips;
+  int ledsPerStrip;
+  int channels;
+  uint8_t orders[8];
+  FILE *log;
+  const char *ppmPattern;
+  uint32_t frames;
+  uint32_t lastCrc;
+  unsigned long lastMicros;
+
+  void writePpm();
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * @brief Time and Serial backends of the native Arduino core
+ */
+
+#include <Arduino.h>
+#include <time.h>
+
+HostSerial Serial;
+
+static uint64_t monotonicMicros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Both counters start at 0 when the program starts, like on the board
+static const uint64_t bootMicros = monotonicMicros();
+
+unsigned long millis()
+{
+  return (unsigned long)((monotonicMicros() - bootMicros) / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)(monotonicMicros() - bootMicros);
+}
+
+void delay(unsigned long ms)
+{
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  nanosleep(&ts, nullptr);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  struct timespec ts;
+  ts.tv_sec = us / 1000000;
+  ts.tv_nsec = (us % 1000000) * 1000L;
+  nanosleep(&ts, nullptr);
+}
@@ -0,0 +1,118 @@
+/*
+ * @brief SD library of the native build, backed by stdio
+ */
+
+#include "SD.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+SDClass SD;
+
+// "/scene.bin" -> "scene.bin", relative to the working directory
+static const char *hostPath(const char *path)
+{
+  while (*path == '/')
+    path++;
+  return path;
+}
+
+int File::read()
+{
+  return f ? fgetc(f) : -1;
+}
+
+size_t File::read(void *buffer, size_t size)
+{
+  return f ? fread(buffer, 1, size, f) : 0;
+}
+
+size_t File::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+size_t File::write(const void *buffer, size_t size)
+{
+  return f ? fwrite(buffer, 1, size, f) : 0;
+}
+
+bool File::seek(uint64_t pos)
+{
+  return f && fseeko(f, pos, SEEK_SET) == 0;
+}
+
+uint64_t File::position()
+{
+  return f ? ftello(f) : 0;
+}
+
+uint64_t File::size()
+{
+  if (!f)
+    return 0;
+  off_t pos = ftello(f);
+  fseeko(f, 0, SEEK_END);
+  off_t end = ftello(f);
+  fseeko(f, pos, SEEK_SET);
+  return end;
+}
+
+int File::available()
+{
+  uint64_t left = size() - position();
+  return left > 0x7FFFFFFF ? 0x7FFFFFFF : (int)left;
+}
+
+bool File::truncate(uint64_t size)
+{
+  if (!f)
+    return false;
+  fflush(f);
+  return ftruncate(fileno(f), size) == 0;
+}
+
+bool File::preAllocate(uint64_t size)
+{
+  return f && posix_fallocate(fileno(f), 0, size) == 0;
+}
+
+void File::flush()
+{
+  if (f)
+    fflush(f);
+}
+
+void File::close()
+{
+  if (f)
+    fclose(f);
+  f = nullptr;
+}
+
+File SDClass::open(const char *path, uint8_t mode)
+{
+  const char *p = hostPath(path);
+  FILE *f;
+  if (mode == FILE_READ)
+    f = fopen(p, "rb");
+  else
+  {
+    // Like the board : create if needed, never truncate
+    f = fopen(p, "r+b");
+    if (!f)
+      f = fopen(p, "w+b");
+    if (f && mode == FILE_WRITE)
+      fseeko(f, 0, SEEK_END);
+  }
+  return File(f);
+}
+
+bool SDClass::exists(const char *path)
+{
+  return access(hostPath(path), F_OK) == 0;
+}
+
+bool SDClass::remove(const char *path)
+{
+  return unlink(hostPath(path)) == 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * @brief ArtnetTransport backed by a POSIX UDP socket (Linux)
+ */
+
+#include "PosixUdpTransport.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static void toSockaddr(IPAddress ip, uint16_t port, struct sockaddr_in &addr)
+{
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  uint32_t raw = ip;
+  memcpy(&addr.sin_addr.s_addr, &raw, 4); // both are in network order
+}
+
+PosixUdpTransport::PosixUdpTransport()
+    : sock(-1), txPort(0), rxSize(0), rxPos(0), txSize(0)
+{
+}
+
+PosixUdpTransport::~PosixUdpTransport()
+{
+  if (sock >= 0)
+    close(sock);
+}
+
+void PosixUdpTransport::setLocalIP(IPAddress ip)
+{
+  local = ip;
+}
+
+void PosixUdpTransport::setBindIP(IPAddress ip)
+{
+  bindIP = ip;
+}
+
+uint8_t PosixUdpTransport::begin(uint16_t port)
+{
+  if (sock >= 0)
+    close(sock);
+
+  sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0)
+  {
+    perror("socket");
+    return 0;
+  }
+
+  int one = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+  // A full gigabit burst of ArtDmx must fit while the loop is busy elsewhere
+  int rcvbuf = POSIX_UDP_RCVBUF;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  toSockaddr(bindIP, port, addr);
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    perror("bind");
+    close(sock);
+    sock = -1;
+    return 0;
+  }
+  return 1;
+}
+
+bool PosixUdpTransport::waitForPacket(int timeoutMs)
+{
+  struct pollfd pfd;
+  pfd.fd = sock;
+  pfd.events = POLLIN;
+  return poll(&pfd, 1, timeoutMs) > 0;
+}
+
+int PosixUdpTransport::parsePacket()
+{
+  rxSize = 0;
+  rxPos = 0;
+  if (sock < 0)
+    return 0;
+
+  struct sockaddr_in from;
+  socklen_t fromLen = sizeof(from);
+  ssize_t n = recvfrom(sock, rxBuffer, sizeof(rxBuffer), MSG_DONTWAIT, (struct sockaddr *)&from, &fromLen);
+  if (n <= 0)
+    return 0;
+
+  uint32_t raw;
+  memcpy(&raw, &from.sin_addr.s_addr, 4);
+  remote = IPAddress(raw);
+  rxSize = (int)n;
+  return rxSize;
+}
+
+int PosixUdpTransport::read(uint8_t *buffer, size_t len)
+{
+  int available = rxSize - rxPos;
+  int n = (int)len < available ? (int)len : available;
+  memcpy(buffer, rxBuffer + rxPos, n);
+  rxPos += n;
+  return n;
+}
+
+IPAddress PosixUdpTransport::remoteIP()
+{
+  return remote;
+}
+
+IPAddress PosixUdpTransport::localIP()
+{
+  if ((uint32_t)local != 0)
+    return local;
+
+  // Ask the routing table which interface would be used : connecting a
+  // datagram socket does not send anything on the wire
+  int probe = socket(AF_INET, SOCK_DGRAM, 0);
+  if (probe < 0)
+    return local;
+  struct sockaddr_in addr;
+  toSockaddr(IPAddress(10, 255, 255, 255), 9, addr);
+  if (connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+  {
+    socklen_t len = sizeof(addr);
+    if (getsockname(probe, (struct sockaddr *)&addr, &len) == 0)
+    {
+      uint32_t raw;
+      memcpy(&raw, &addr.sin_addr.s_addr, 4);
+      local = IPAddress(raw);
+    }
+  }
+  close(probe);
+  return local;
+}
+
+int PosixUdpTransport::beginPacket(IPAddress ip, uint16_t port)
+{
+  txIP = ip;
+  txPort = port;
+  txSize = 0;
+  return 1;
+}
+
+size_t PosixUdpTransport::write(const uint8_t *buffer, size_t size)
+{
+  if (txSize + size > sizeof(txBuffer))
+    size = sizeof(txBuffer) - txSize;
+  memcpy(txBuffer + txSize, buffer, size);
+  txSize += size;
+  return size;
+}
+
+int PosixUdpTransport::endPacket()
+{
+  if (sock < 0)
+    return 0;
+  struct sockaddr_in addr;
+  toSockaddr(txIP, txPort, addr);
+  ssize_t n = sendto(sock, txBuffer, txSize, 0, (struct sockaddr *)&addr, sizeof(addr));
+  return n == (ssize_t)txSize ? 1 : 0;
+}
+
+uint8_t PosixUdpTransport::joinMulticast(IPAddress group)
+{
+  if (sock < 0)
+    return 0;
+
+  struct ip_mreq mreq;
+  uint32_t raw = group;
+  memcpy(&mreq.imr_multiaddr.s_addr, &raw, 4);
+  raw = bindIP;
+  memcpy(&mreq.imr_interface.s_addr, &raw, 4);
+  // Linux allows 20 groups per socket unless net.ipv4.igmp_max_memberships is raised
+  if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+  {
+    perror("IP_ADD_MEMBERSHIP");
+    return 0;
+  }
+  return 1;
+}
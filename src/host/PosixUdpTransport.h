@@ -0,0 +1,61 @@
+/*
+ * @brief ArtnetTransport backed by a POSIX UDP socket (Linux)
+ *
+ * @details Non blocking socket with a large kernel receive buffer so a
+ * workstation can be fed at gigabit rates. waitForPacket() lets the host
+ * loop sleep instead of spinning on parsePacket().
+ *
+ */
+
+#ifndef POSIX_UDP_TRANSPORT_H
+#define POSIX_UDP_TRANSPORT_H
+
+#include <Arduino.h>
+#include "../ArtnetTransport.h"
+
+#define POSIX_UDP_MAX_PACKET 1500
+#define POSIX_UDP_RCVBUF (4 * 1024 * 1024)
+
+class PosixUdpTransport : public ArtnetTransport
+{
+public:
+  PosixUdpTransport();
+  ~PosixUdpTransport();
+
+  // Address used in the ArtPollReply. Autodetected when left to 0.0.0.0
+  void setLocalIP(IPAddress ip);
+  // Bind on a specific interface address instead of INADDR_ANY
+  void setBindIP(IPAddress ip);
+  // Block up to timeoutMs for a datagram, return true if one is pending
+  bool waitForPacket(int timeoutMs);
+
+  uint8_t begin(uint16_t port);
+  int parsePacket();
+  int read(uint8_t *buffer, size_t len);
+  IPAddress remoteIP();
+  IPAddress localIP();
+  int beginPacket(IPAddress ip, uint16_t port);
+  size_t write(const uint8_t *buffer, size_t size);
+  int endPacket();
+  uint8_t joinMulticast(IPAddress group);
+
+  inline int getSocket(void)
+  {
+    return sock;
+  }
+
+private:
+  int sock;
+  IPAddress bindIP;
+  IPAddress local;
+  IPAddress remote;
+  IPAddress txIP;
+  uint16_t txPort;
+  uint8_t rxBuffer[POSIX_UDP_MAX_PACKET];
+  int rxSize;
+  int rxPos;
+  uint8_t txBuffer[POSIX_UDP_MAX_PACKET];
+  size_t txSize;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * @brief SD library of the native build, backed by stdio
+ *
+ * @details The card root is the working directory : SD.open("/scene.bin")
+ * opens ./scene.bin. Only the calls used by the shared sources are there.
+ *
+ */
+
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include <Arduino.h>
+
+#define FILE_READ 0
+#define FILE_WRITE 1 // created if needed, writes go to the end
+#define FILE_WRITE_BEGIN 2 // created if needed, writes start at the beginning
+#define BUILTIN_SDCARD 254
+
+class File
+{
+public:
+  File() : f(nullptr) {}
+  File(FILE *file) : f(file) {}
+
+  int read();
+  size_t read(void *buffer, size_t size);
+  size_t write(uint8_t b);
+  size_t write(const void *buffer, size_t size);
+  bool seek(uint64_t pos);
+  uint64_t position();
+  uint64_t size();
+  int available();
+  bool truncate(uint64_t size);
+  // Reserve size bytes on the disk, the file stays empty
+  bool preAllocate(uint64_t size);
+  void flush();
+  void close();
+
+  operator bool() const
+  {
+    return f != nullptr;
+  }
+
+private:
+  FILE *f;
+};
+
+class SDClass
+{
+public:
+  bool begin(uint8_t csPin) { return true; }
+  File open(const char *path, uint8_t mode = FILE_READ);
+  bool exists(const char *path);
+  bool remove(const char *path);
+};
+
+extern SDClass SD;
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * @brief Native entry point : run the Artnet receive path on a workstation
+ *
+ * @details Build with "pio run -e native" then run
+ *   .pio/build/native/program [--start 0] [--universes 4] [--broadcast 192.168.0.255] [--ip 192.168.0.10] [--bind 0.0.0.0]
+ * Every second the packet rates seen by Artnet::read are printed.
+ * With --leds the universes also go through the firmware frame path
+ * (FramePipeline : sequences, merge, UniverseMap, PixelMap, UniverseBlit)
+ * into a FramePixelOutput :
+ *   program --strips 2 --leds 295 [--order GRB] [--sync] [--frames frames.log] [--ppm frame%06lu.ppm]
+ * A frame is shown when all its universes are in, or on ArtSync with --sync.
+ *
+ */
+
+// pio test links src/ with the test main() instead
+#ifndef PIO_UNIT_TESTING
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include "../ArtnetGithub.h"
+#include "../UniverseMap.h"
+#include "../PixelMap.h"
+#include "../PixelBlit.h"
+#include "../UniverseBlit.h"
+#include "../UniverseTracker.h"
+#include "../SequenceTracker.h"
+#include "../UniverseMerger.h"
+#include "../PowerLimiter.h"
+#include "../ShowScheduler.h"
+#include "../PerfCounters.h"
+#include "../FramePipeline.h"
+#include "PosixUdpTransport.h"
+#include "FramePixelOutput.h"
+
+static Artnet artnet;
+static PosixUdpTransport transport;
+
+// Pixel path, when --leds is given
+static bool pixelPath = false;
+static int startUniverse = 0;
+static UniverseMap universeMap;
+static PixelMap pixelMap;
+static PowerLimiter power; // disabled
+static UniverseBlit blitter;
+static UniverseTracker universesReceived;
+static SequenceTracker sequences;
+static UniverseMerger merger;
+static ShowScheduler scheduler;
+static PerfCounters perf;
+static FramePixelOutput output;
+static uint8_t *ingestMemory;
+static FramePipeline pipeline;
+
+static unsigned long dmxPackets = 0;
+static unsigned long dmxBytes = 0;
+static unsigned long syncPackets = 0;
+
+static void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP)
+{
+  dmxPackets++;
+  dmxBytes += length;
+  if (!pixelPath)
+    return;
+
+  pipeline.receive(universe - startUniverse, sequence, data, length, remoteIP);
+}
+
+static void onSync(IPAddress remoteIP)
+{
+  syncPackets++;
+  if (pixelPath)
+    pipeline.sync();
+}
+
+static IPAddress parseIP(const char *s)
+{
+  struct in_addr addr;
+  if (inet_pton(AF_INET, s, &addr) != 1)
+  {
+    fprintf(stderr, "invalid address %s\n", s);
+    exit(1);
+  }
+  uint32_t raw;
+  memcpy(&raw, &addr.s_addr, 4);
+  return IPAddress(raw);
+}
+
+int main(int argc, char **argv)
+{
+  int numberOfUniverses = 4;
+  IPAddress broadcast(255, 255, 255, 255);
+  int numberOfStrips = 1;
+  int ledsPerStrip = 0;
+  uint8_t order = PIXEL_GRB;
+  const char *framesPath = nullptr;
+  const char *ppmPattern = nullptr;
+  bool sync = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--start") && i + 1 < argc)
+      startUniverse = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--universes") && i + 1 < argc)
+      numberOfUniverses = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--broadcast") && i + 1 < argc)
+      broadcast = parseIP(argv[++i]);
+    else if (!strcmp(argv[i], "--ip") && i + 1 < argc)
+      transport.setLocalIP(parseIP(argv[++i]));
+    else if (!strcmp(argv[i], "--bind") && i + 1 < argc)
+      transport.setBindIP(parseIP(argv[++i]));
+    else if (!strcmp(argv[i], "--strips") && i + 1 < argc)
+      numberOfStrips = min(atoi(argv[++i]), PIXEL_MAX_STRIPS);
+    else if (!strcmp(argv[i], "--leds") && i + 1 < argc)
+      ledsPerStrip = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--order") && i + 1 < argc)
+      order = pixelOrderFromName(argv[++i], PIXEL_GRB);
+    else if (!strcmp(argv[i], "--sync"))
+      sync = true;
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+      framesPath = argv[++i];
+    else if (!strcmp(argv[i], "--ppm") && i + 1 < argc)
+      ppmPattern = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [--start U] [--universes N] [--broadcast A.B.C.D] [--ip A.B.C.D] [--bind A.B.C.D]\n"
+                      "          [--strips N --leds N [--order GRB|GRBW..] [--sync] [--frames FILE|-] [--ppm PATTERN]]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  if (ledsPerStrip > 0)
+  {
+    // Same tables as the firmware, the number of universes comes from the leds
+    uint8_t orders[PIXEL_MAX_STRIPS];
+    pixelMap.begin(ledsPerStrip);
+    for (int s = 0; s < numberOfStrips; s++)
+    {
+      orders[s] = order;
+      pixelMap.addStrip(ledsPerStrip, order, ledsPerStrip, false);
+    }
+    universeMap.begin(pixelMap.getNumberOfPixels(), pixelChannels(order), true);
+    numberOfUniverses = universeMap.getNumberOfUniverses();
+    power.begin(numberOfUniverses, numberOfStrips, 0, 0);
+    blitter.begin(&universeMap, &pixelMap, &power);
+    universesReceived.begin(numberOfUniverses);
+    sequences.begin(numberOfUniverses * MERGE_SOURCES);
+    merger.begin(numberOfUniverses, MERGE_OFF);
+    output.setLayout(numberOfStrips, ledsPerStrip, orders);
+    if (!output.setLog(framesPath))
+    {
+      fprintf(stderr, "can not create %s\n", framesPath);
+      return 1;
+    }
+    output.setPpmPattern(ppmPattern);
+    output.begin();
+    ingestMemory = (uint8_t *)calloc(output.getSize(), 1);
+    pipeline.begin(&output, &scheduler, &blitter, &universesReceived, &sequences, &merger, &power, &perf,
+                   ingestMemory, output.getSize());
+    pipeline.setSyncMode(sync);
+    // show() does not wait on a workstation, every frame goes out
+    pipeline.setCoalesce(false);
+    pixelPath = true;
+  }
+
+  artnet.setTransport(&transport);
+  artnet.beginCustomArtPoll(startUniverse, numberOfUniverses);
+  if (transport.getSocket() < 0)
+    return 1;
+  artnet.setBroadcast(broadcast);
+  artnet.setArtDmxCallback(onDmxFrame);
+  artnet.setArtSyncCallback(onSync);
+
+  Serial.print("Artnet host listening on ");
+  Serial.print(transport.localIP());
+  Serial.print(":");
+  Serial.println(ART_NET_PORT);
+
+  unsigned long lastReport = millis();
+  for (;;)
+  {
+    // short timeout : read() also sends the pending ArtPollReply pages
+    transport.waitForPacket(1);
+    // drain everything the kernel has queued before sleeping again
+    while (artnet.read())
+      ;
+    if (pixelPath)
+      pipeline.update();
+
+    unsigned long now = millis();
+    if (now - lastReport >= 1000)
+    {
+      float seconds = (now - lastReport) / 1000.0f;
+      printf("dmx %.0f pkt/s  %.2f Mbit/s  sync %.0f /s", dmxPackets / seconds,
+             dmxBytes * 8 / seconds / 1e6, syncPackets / seconds);
+      if (pixelPath)
+        printf("  frames %lu crc %08lx", (unsigned long)output.getFrames(), (unsigned long)output.getLastCrc());
+      printf("\n");
+      fflush(stdout);
+      dmxPackets = 0;
+      dmxBytes = 0;
+      syncPackets = 0;
+      lastReport = now;
+    }
+  }
+  return 0;
+}
+
+#endif
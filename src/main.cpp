@@ -6,6 +6,7 @@
  * @octoWS2811 https://www.pjrc.com/teensy/td_libs_OctoWS2811.html : to control the leds
  * @arduinoJson https://arduinojson.org/v6/doc/ : to parse the json file
  * @arnet https://github.com/natcl/Artnet !!! This is a fork of the original librayri in order to add a specific poll request
+ * @sacn ANSI E1.31 can feed the same universes, see E131.h
  *
  * @details This example may be copied under the terms of the MIT license, see the LICENSE file for details
  *
@@ -15,6 +16,25 @@
 #include <SD.h>
 #include <ArduinoJson.h>
 #include "ArtnetGithub.h"
+#include "E131.h"
+#include "PixelBlit.h"
+#include "PixelMap.h"
+#include "PixelOutput.h"
+#include "UniverseBlit.h"
+#include "FramePipeline.h"
+#include "UniverseTracker.h"
+#include "UniverseMap.h"
+#include "SequenceTracker.h"
+#include "PerfCounters.h"
+#include "ShowScheduler.h"
+#include "Dither.h"
+#include "PowerLimiter.h"
+#include "FrameInterpolator.h"
+#include "UniverseMerger.h"
+#include "ScenePlayer.h"
+#include "SceneRecorder.h"
+#include "ConfigCache.h"
+#include "BootTimeline.h"
 #include <OctoWS2811.h>
 
 //#define DEBUG_LVL 1 // Comment this line to remove all debug messages
@@ -32,13 +52,38 @@ struct Config
   int numberoflines;
   int startuniverse;
   int numberofstrips;
-  int ledsperstrip;
-  int numberofleds;
+  int ledsperstrip; // OctoWS2811 strip size, the longest strip
+  int numberofleds; // leds of all the strips, received in the universes
+  int outputleds;   // numberofstrips * ledsperstrip, the OctoWS2811 buffer
+  bool rgbw;            // true : SK6812 RGBW leds, 4 channels per pixel
+  int channelsperpixel; // 3, 4 with rgbw
+  int stripleds[PIXEL_MAX_STRIPS];
+  uint8_t striporder[PIXEL_MAX_STRIPS];
+  int stripledsperline[PIXEL_MAX_STRIPS];
+  bool stripserpentine[PIXEL_MAX_STRIPS]; // one line out of two wired backwards
   int numberofchannels;
   int numberofuniverses;
   int maxuniverses;
+  bool coalesce; // true : skip frames when the bus is busy instead of waiting for it
+  bool dither;   // true : resend the frame at the wire rate with temporal dithering
+  bool interpolate; // true : blend the last two frames at the wire rate
+  int maxmilliamps;     // current budget of one strip, 0 = no limit
+  int channelmilliamps; // current of one channel at 255
+  bool universealign; // true : 170 pixels per universe, false : pixels packed over 512 channels
+  bool sacn;             // true : also receive sACN (E1.31)
+  int sacnstartuniverse; // sACN universe received as startuniverse
+  uint8_t merge;         // MERGE_OFF, MERGE_HTP or MERGE_LTP for two senders on a universe
+  char scenefile[32];    // scene played when the network is lost
+  int scenetimeout;      // ms without DMX before playing it, 0 = never
+  char recordfile[32];   // written by the 'w' serial command
+  int recordmegabytes;   // space reserved for a recording
+  float gamma[3];
+  uint8_t whitebalance[3];
 };
 const char *filename = "/configteensy.json"; // <- SD library uses 8.3 filenames
+const char *cachefilename = "/configteensy.bin"; // parsed configuration, rewritten when the JSON changes
+// JsonDocument bytes per JSON byte, enough for a file of small numbers
+#define CONFIG_JSON_CAPACITY_RATIO 8
 Config configlist;
 
 byte ip[] = {192, 168, 0, 34};
@@ -56,6 +101,28 @@ boolean powerLedLOn = false;
 
 unsigned long lastMsgTime = 0;
 
+// ------- BOOT ---------------
+// Time the test pattern stays on, unless DMX comes first
+#define BOOT_TEST_PATTERN_MS 5000
+// First DHCP attempt, at boot
+#define BOOT_DHCP_TIMEOUT_MS 3000
+#define BOOT_DHCP_RESPONSE_MS 1000
+// Next attempts : Ethernet.begin() blocks and the leds (scene included) freeze
+// meanwhile, so the retries start short. Each failed one doubles the timeout,
+// up to BOOT_DHCP_RETRY_MAX_MS : a slow server, or a switch port still in its
+// spanning tree delay, still gets a full exchange. The response timeout is half of it
+#define BOOT_DHCP_RETRY_TIMEOUT_MS 500
+#define BOOT_DHCP_RETRY_MAX_MS 8000
+// Pause between two DHCP attempts
+#define BOOT_DHCP_RETRY_MS 10000
+BootTimeline boot; // send 'b' on the serial port to print it again
+bool networkUp = false;
+unsigned long lastNetworkAttempt = 0;
+unsigned long dhcpRetryTimeout = BOOT_DHCP_RETRY_TIMEOUT_MS;
+bool ready = false; // end of setup() reached : without SD card the node stays idle
+bool testPatternOn = false;
+unsigned long testPatternStart = 0;
+
 // ------- WS2811 GLOBAL VARIABLES ---------------
 
 // const int ledsPerLine = 59;
@@ -68,11 +135,20 @@ unsigned long lastMsgTime = 0;
 DMAMEM int *displayMemory;
 // int drawingMemory[ledsPerStrip * 6];
 int *drawingMemory;
-const int config = WS2811_GRB | WS2811_800kHz;
+// The DMX callbacks write here. A completed frame is copied to drawingMemory
+// so the next one can come in while it waits for the bus
+uint8_t *ingestMemory;
+int config = WS2811_GRB | WS2811_800kHz; // WS2811_GRBW with rgbw
+const uint8_t pixelOrder = PIXEL_GRB; // color order of config, default of the strips
+ColorLut colorLut;                    // gamma and white balance, built by loadConfiguration
+Dither dither;
+PowerLimiter power; // per strip current budget
+FrameInterpolator interpolator;
 // const byte listPins[numStrips] = {2, 7};
 //  const byte listPins[numPins] = {2};
 //  OctoWS2811 leds(ledsPerStrip, displayMemory, drawingMemory, config, numStrips, listPins);
-OctoWS2811 *leds;
+PixelOutput *leds; // OctoWS2811 strips
+ShowScheduler scheduler; // wire time of a frame, and frame waiting for the bus
 
 
 // ------Arnet GLOBAL VARIABLES -------------------
@@ -81,23 +157,35 @@ Artnet artnet;
 // const int numUniverses = numberOfChannels / 512 + ((numberOfChannels % 512) ? 1 : 0);
 // const int maxUniverse = startUniverse + numUniverses; // This max is not accessible.
 //  bool universesReceived[numUniverses];
-bool *universesReceived;
-bool sendFrame = 1; // flag , if==1, all universes got data, and leds can be updated.
-int previousDataLength = 0;
+UniverseTracker universesReceived; // when complete, all universes got data, and leds can be updated.
+UniverseMap universeMap; // built by loadConfiguration
+PixelMap pixelMap;       // universe pixel -> strip led, built by loadConfiguration
+UniverseBlit blitter;    // copy of a universe through universeMap and pixelMap
+SequenceTracker sequences; // drop late ArtDmx packets, count the lost ones. One entry per universe and merge slot
+UniverseMerger merger;     // HTP / LTP merge of two senders
+ScenePlayer player;        // stand-alone scene, see configlist.scenetimeout
+SceneRecorder recorder;    // 'w' on the serial port starts / stops a recording
+FramePipeline pipeline;    // sequences, merge, copy and show of the DMX frames
+E131 e131;                 // sACN receiver, checks its own sequences and priorities
 // bool useSync = true; // USE ARNET SYNCRONISATION
 // bool isDHCP = true;  // USE DHCP
 
 // ------- Debug variables ------------------------
 int frameCount = 0;
+PerfCounters perf; // send 'c' on the serial port to print them, 'r' to reset them
 
 // ---------Header --------------------------------
 // NETWORK
-int startDHCPEthernet();
+int startDHCPEthernet(unsigned long timeout, unsigned long responseTimeout);
 int startIPEthernet();
+void startNetwork();
+// BOOT
+void updateTestPattern();
 // ARNET
 void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP);
-void onDmxFrameSync(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP);
 void onSync(IPAddress remoteIP);
+// SACN
+void onE131Frame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP);
 // LED TEST
 void initTest();
 void initTestStrip();
@@ -108,8 +196,17 @@ void ledBlink();
 void ledOff();
 // SD
 void loadConfiguration(const char *filename, Config &config);
+void applyConfiguration(Config &config);
 void printConfiguration();
 void ledShow();
+void printMissingUniverses();
+// SCENE
+void updatePlayback();
+void toggleRecording();
+// COUNTERS
+void printCounters();
+void updateNodeReport();
+void readSerialCommand();
 
 /********************************************************
  *                   SETUP                              *
@@ -126,9 +223,7 @@ void setup()
     delay(100);
   }
 #endif
-  delay(1500);
-  Serial.println("LED NEW initstrip");
-  delay(100);
+  boot.mark("serial");
 
   //---------SD SETUP -------------
 
@@ -148,70 +243,92 @@ void setup()
   }
   loadConfiguration(filename, configlist);
   printConfiguration();
+  boot.mark("configuration loaded");
 
   // -------- LEDS SETUP---------
   Serial.println("Start Led Init");
   // displayMemory = new int[ledsPerStrip * 6];
 
-  displayMemory = (int *)malloc(configlist.ledsperstrip * 6 * sizeof(int));
-  drawingMemory = (int *)malloc(configlist.ledsperstrip * 6 * sizeof(int));
-  leds = new OctoWS2811(configlist.ledsperstrip, displayMemory, drawingMemory, config, configlist.numberofstrips, configlist.arduinopins);
+  // 8 strips of ledsperstrip leds, 3 or 4 bytes each
+  if (configlist.rgbw)
+    config = WS2811_GRBW | WS2811_800kHz;
+  displayMemory = (int *)malloc(configlist.ledsperstrip * configlist.channelsperpixel * 2 * sizeof(int));
+  drawingMemory = (int *)malloc(configlist.ledsperstrip * configlist.channelsperpixel * 2 * sizeof(int));
+  ingestMemory = (uint8_t *)calloc(configlist.outputleds * configlist.channelsperpixel, 1);
+  if (configlist.dither)
+  {
+    dither.begin(configlist.numberofstrips, configlist.ledsperstrip, configlist.striporder);
+    pipeline.setDither(&dither);
+  }
+  if (configlist.interpolate)
+  {
+    interpolator.begin(configlist.outputleds * configlist.channelsperpixel);
+    pipeline.setInterpolator(&interpolator);
+  }
+  leds = new OctoPixelOutput(configlist.ledsperstrip, displayMemory, drawingMemory, config, configlist.numberofstrips, configlist.arduinopins);
   Serial.println("Start Led Begin");
   leds->begin();
-  Serial.println("Start Led test");
-  delay(100);
+  boot.mark("leds started");
+  scheduler.begin(configlist.ledsperstrip, configlist.channelsperpixel, (config & WS2811_400kHz) ? SHOW_BIT_NANOS_400KHZ : SHOW_BIT_NANOS_800KHZ);
+  Serial.print("Frame wire time us: ");
+  Serial.print(scheduler.getFrameMicros());
+  Serial.print(" max fps: ");
+  Serial.println(scheduler.getMaxFrameRate());
+  // The pattern stays on while the network comes up, loop() clears it
   initTestStripFirst();
-  delay(100);
+  boot.mark("test pattern shown");
 
   // --------- Extra 5mm led setup ------------
   pinMode(pinLedOn, OUTPUT);
   pinMode(pinLedArnet, OUTPUT);
 
 
-  // ---------- ETHERNET SETUP ------------
-  // TODO, si on est en mode IP fixe, et qu'elle ne fonctionne pas, on pourrait aussi, tenter le dhcp dans la foulée.
-  Serial.println("Ethernet Begin");
-  // int er = startIPEthernet();
-  int er;
-  if (configlist.isdhcp)
-  {
-    er = startDHCPEthernet();
-  }
-  else
-  {
-    er = startIPEthernet();
-  }
-  Serial.print("Ethernet error: ");
-  Serial.println(er);
-  delay(100);
-  if (er == 0)
-  {
-    ledOK();
-  }
-  else
-  {
-    ledError();
-  }
-
-  // ------- ARNET SETUP ------------
-
-  Serial.println("start arnet");
-  // artnet.begin(); //begin artnet with custom constructor
-  artnet.beginCustomArtPoll(configlist.startuniverse, configlist.numberofuniverses);
-  artnet.setBroadcast(configlist.broadcast);
-  universesReceived = (bool *)malloc(configlist.numberofuniverses * sizeof(bool));
+  // ------- RECEPTION SETUP ------------
+  // Everything that does not need the network, the sockets are opened by startNetwork()
+  universesReceived.begin(configlist.numberofuniverses);
+  sequences.begin(configlist.numberofuniverses * MERGE_SOURCES);
+  merger.begin(configlist.numberofuniverses, configlist.merge);
+  power.begin(configlist.numberofuniverses, configlist.numberofstrips, configlist.maxmilliamps, configlist.channelmilliamps);
+  blitter.begin(&universeMap, &pixelMap, &power);
+  pipeline.begin(leds, &scheduler, &blitter, &universesReceived, &sequences, &merger, &power, &perf,
+                 ingestMemory, configlist.outputleds * configlist.channelsperpixel);
+  pipeline.setColorLut(&colorLut);
+  pipeline.setRecorder(&recorder);
+  pipeline.setSyncMode(configlist.issync);
+  pipeline.setCoalesce(configlist.coalesce);
   artnet.setArtDmxCallback(onDmxFrame);
   if (configlist.issync)
-  {
     artnet.setArtSyncCallback(onSync); // test sync
-    artnet.setArtDmxCallback(onDmxFrameSync);
+
+  // ------- SCENE SETUP ------------
+  if (configlist.scenetimeout > 0)
+  {
+    if (player.open(configlist.scenefile, configlist.numberofuniverses))
+    {
+      Serial.print("Scene frames: ");
+      Serial.println(player.getFrameCount());
+    }
+    else
+    {
+      Serial.print("No scene to play in ");
+      Serial.println(configlist.scenefile);
+    }
   }
-  else
+
+  // ------- SACN SETUP ------------
+  if (configlist.sacn)
   {
-    artnet.setArtDmxCallback(onDmxFrame);
+    e131.setDmxCallback(onE131Frame);
+    if (configlist.issync)
+      e131.setSyncCallback(onSync);
   }
+  boot.mark("reception ready");
 
-  Serial.println("Arnet OK");
+  // ---------- ETHERNET SETUP ------------
+  // Fixed IP is immediate. DHCP gets short attempts, retried from loop() so
+  // the test pattern and the SD scene keep running without a network
+  startNetwork();
+  ready = true;
 }
 
 /********************************************************
@@ -220,9 +337,50 @@ void setup()
 
 void loop()
 {
+  // setup() stopped early, nothing has been started
+  if (!ready)
+    return;
+
   // we call the read function inside the loop
   // Not used anymore
-  int trame = artnet.read();
+  unsigned long readStart = micros();
+  int trame = networkUp ? artnet.read() : 0;
+  if (trame)
+  {
+    perf.countPacket(trame);
+    if (trame == ART_DMX || trame == ART_SYNC)
+      perf.callbackTotal += micros() - readStart;
+  }
+  if (!networkUp && millis() - lastNetworkAttempt > BOOT_DHCP_RETRY_MS)
+    startNetwork();
+  else if (configlist.sacn && networkUp)
+  {
+    readStart = micros();
+    int sacn = e131.read();
+    if (sacn)
+    {
+      perf.countPacket(sacn);
+      perf.callbackTotal += micros() - readStart;
+      trame = sacn;
+    }
+  }
+  perf.loops++;
+
+  // pending frame, dither and interpolation refresh
+  pipeline.update();
+  if (testPatternOn)
+    updateTestPattern();
+  if (player.isOpen())
+    updatePlayback();
+  // the card is written only when no packet was waiting
+  if (!trame && recorder.isRecording())
+    recorder.update();
+  if (recorder.isFull() && recorder.isRecording())
+    toggleRecording();
+  if (perf.update(millis()))
+    updateNodeReport();
+  if (Serial.available())
+    readSerialCommand();
 
   // turn on the led on pin 31 if trame is > 0
   if (millis() - lastMsgTime > 1000)
@@ -241,6 +399,12 @@ void loop()
 #ifdef DEBUG_LVL
     Serial.print("ping: ");
     Serial.println(millis());
+    if (!configlist.issync)
+      printMissingUniverses();
+    Serial.print("packets lost: ");
+    Serial.print(sequences.getLost());
+    Serial.print(" late: ");
+    Serial.println(sequences.getDropped());
 #endif
     frameCount = 0;
     powerLedLOn = !powerLedLOn;
@@ -249,14 +413,14 @@ void loop()
 
 }
 
-int startDHCPEthernet()
+int startDHCPEthernet(unsigned long timeout, unsigned long responseTimeout)
 {
 
   int error = 0;
 
   // start the Ethernet connection:
   Serial.println("Initialize Ethernet with DHCP:");
-  if (Ethernet.begin(configlist.mac) == 0)
+  if (Ethernet.begin(configlist.mac, timeout, responseTimeout) == 0)
   {
     Serial.println("Failed to configure Ethernet using DHCP");
     if (Ethernet.hardwareStatus() == EthernetNoHardware)
@@ -324,32 +488,99 @@ int startIPEthernet()
   return error;
 }
 
+// Bring the network up then open the Art-Net and sACN sockets. With DHCP a
+// failed attempt returns, loop() calls again
+void startNetwork()
+{
+  // TODO, si on est en mode IP fixe, et qu'elle ne fonctionne pas, on pourrait aussi, tenter le dhcp dans la foulée.
+  int er;
+  if (configlist.isdhcp)
+  {
+    // the first attempt gets the time a DHCP server needs, the retries must not stall the leds
+    if (lastNetworkAttempt == 0)
+    {
+      er = startDHCPEthernet(BOOT_DHCP_TIMEOUT_MS, BOOT_DHCP_RESPONSE_MS);
+    }
+    else
+    {
+      er = startDHCPEthernet(dhcpRetryTimeout, dhcpRetryTimeout / 2);
+      dhcpRetryTimeout = min(dhcpRetryTimeout * 2, (unsigned long)BOOT_DHCP_RETRY_MAX_MS);
+    }
+  }
+  else
+  {
+    er = startIPEthernet();
+  }
+  Serial.print("Ethernet error: ");
+  Serial.println(er);
+  lastNetworkAttempt = millis();
+  if (er != 0 && configlist.isdhcp)
+  {
+    boot.mark("DHCP failed, retrying");
+    return;
+  }
+  boot.mark("ethernet started");
+
+  // ------- ARNET SETUP ------------
+  Serial.println("start arnet");
+  // artnet.begin(); //begin artnet with custom constructor
+  artnet.beginCustomArtPoll(configlist.startuniverse, configlist.numberofuniverses);
+  artnet.setBroadcast(configlist.broadcast);
+  Serial.println("Arnet OK");
+
+  // ------- SACN SETUP ------------
+  if (configlist.sacn)
+  {
+    e131.begin(configlist.sacnstartuniverse, configlist.numberofuniverses);
+    Serial.println("sACN OK");
+  }
+  networkUp = true;
+  boot.mark("receiving art-net");
+}
+
+// End of the boot test pattern, early if DMX is already there
+void updateTestPattern()
+{
+  if (lastMsgTime == 0 && millis() - testPatternStart < BOOT_TEST_PATTERN_MS)
+    return;
+  testPatternOn = false;
+  // Network status on the leds, as long as nothing else has been shown
+  if (lastMsgTime == 0 && !player.isPlaying())
+  {
+    if (networkUp)
+      ledOK();
+    else
+      ledError();
+  }
+  boot.mark("test pattern done");
+}
+
 void initTest()
 {
   ledOff();
 
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 127, 0, 0);
   }
   delay(20);
   ledShow();
   delay(2000);
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 0, 127, 0);
   }
   delay(20);
   ledShow();
   delay(2000);
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 0, 0, 127);
   }
   ledShow();
   delay(20);
   delay(2000);
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 0, 0, 0);
   }
@@ -369,18 +600,16 @@ leds->setPixel(3, 255,255, 255);
 leds->setPixel(4, 255, 0, 0);
 leds->setPixel(5, 0, 255, 0);
 leds->setPixel(6, 0,0, 255);
-delay(20);
 leds->show();
-delay(5000);
-
-
-
+// cleared by updateTestPattern()
+testPatternOn = true;
+testPatternStart = millis();
 }
 
 void initTestStrip()
 {
 
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 0, 0, 0);
   }
@@ -391,7 +620,7 @@ void initTestStrip()
   {
     for (int j = 0; j < configlist.numberoflines; j++)
     {
-      for (int k = 0; k < configlist.ledsperline; k++)
+      for (int k = 0; k < configlist.ledsperline && j * configlist.ledsperline + k < configlist.stripleds[i]; k++)
       {
 
         int indexLed = (i * configlist.ledsperstrip) + (j * configlist.ledsperline) + k;
@@ -408,7 +637,7 @@ void initTestStrip()
 
 void ledError()
 {
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 20, 0, 0);
   }
@@ -418,7 +647,7 @@ void ledError()
 
 void ledOK()
 {
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 20, 0, 0);
   }
@@ -433,7 +662,7 @@ void ledOK()
 void ledOff()
 {
   // turn all led to 0,0,0
-  for (int i = 0; i < configlist.numberofleds; i++)
+  for (int i = 0; i < configlist.outputleds; i++)
   {
     leds->setPixel(i, 0, 0, 0);
   }
@@ -452,7 +681,7 @@ void ledBlink()
   {
     Serial.print("led blink j=");
     Serial.println(j);
-    for (int i = (configlist.numberofleds - j); i < configlist.numberofleds; i++)
+    for (int i = (configlist.outputleds - j); i < configlist.outputleds; i++)
     {
       leds->setPixel(i, 255, 255, 255);
     }
@@ -465,19 +694,30 @@ void ledBlink()
   delay(4000);
 }
 
+// Used by the led tests. show() itself waits for the previous frame to be
+// out of the wire, there is no need to wait after it
 void ledShow()
 {
-  if (leds->busy())
+  leds->show();
+}
+
+// Serial print the universes of the current frame that did not come in yet
+void printMissingUniverses()
+{
+  uint16_t missing[16];
+  int count = universesReceived.getMissing(missing, 16);
+  Serial.print("missing universes: ");
+  Serial.print(universesReceived.getMissingCount());
+  for (int i = 0; i < count; i++)
   {
-    Serial.println("leds busy");
+    Serial.print(" ");
+    Serial.print(configlist.startuniverse + missing[i]);
   }
-  leds->show();
-  delay(0.33 * configlist.numberofleds);
+  Serial.println();
 }
 
 void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP)
 {
-  sendFrame = 1;
   lastMsgTime = millis();
 
 #ifdef DEBUG_LVL
@@ -494,96 +734,54 @@ void onDmxFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *d
   
 #endif
 
-  // Store which universe has got in
-  // universesReceived is an array from 0 to numUniverses.
-  // 0 represent startUniverse
-  // numUniverses represent MaxUniverse
-
-  if (universe >= configlist.startuniverse && universe < configlist.maxuniverses)
-    universesReceived[universe - configlist.startuniverse] = 1;
-
-  for (int i = 0; i < configlist.numberofuniverses; i++)
-  {
-    if (universesReceived[i] == 0)
-    {
-      sendFrame = 0;
-      break;
-    }
-  }
-
-  // read universe and put into the right part of the display buffer
-  for (int i = 0; i < length / 3; i++)
-  {
-    int led = i + (universe - configlist.startuniverse) * (previousDataLength / 3);
-    if (led >= 0 && led < configlist.numberofleds)
-      leds->setPixel(led, data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
-  }
-  previousDataLength = length;
-
-  if (sendFrame)
-  {
-    leds->show();
-    //  Reset universeReceived to 0
-    memset(universesReceived, 0, configlist.numberofuniverses);
-  }
+  // sequence check, merge, copy to the leds and show once the frame is complete
+  pipeline.receive(universe - configlist.startuniverse, sequence, data, length, remoteIP);
 }
 
-void onDmxFrameSync(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP)
+void onSync(IPAddress remoteIP)
 {
-
-  lastMsgTime = millis();
-
-#ifdef DEBUG_LVL
-  // print in one line, universe, lenght and sequence, in a nice way
-  // DONT USE IT, because it freeze artnet process
-  
-
-    Serial.print("Universe: ");
-    Serial.print(universe);
-    Serial.print(" | Data Lenght: ");
-    Serial.print(length);
-    Serial.print(" | Sequence: ");
-    Serial.print(sequence);
-    Serial.println("");
-    
-
-#endif
-
-  // Store which universe has got in
-  // universesReceived is an array from 0 to configlist.numofuniverses.
-  // 0 represent startUniverse
-  // numUniverses represent MaxUniverse
-
-  // read universe and put into the right part of the display buffer
-  for (int i = 0; i < length / 3; i++)
-  {
-    int led = i + (universe - configlist.startuniverse) * (previousDataLength / 3);
-    if (led < configlist.numberofleds && led >= 0)
-    { // led>=0 is a security, because if it's receiving universe=1 with startUniverse at 7
-      leds->setPixel(led, data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
-    }
-  }
-  previousDataLength = length;
+  pipeline.sync();
 }
 
-void onSync(IPAddress remoteIP)
+// sACN universes are renumbered to the Art-Net ones, then handled the same way
+void onE131Frame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t *data, IPAddress remoteIP)
 {
-  leds->show();
+  universe = universe - configlist.sacnstartuniverse + configlist.startuniverse;
+  onDmxFrame(universe, length, sequence, data, remoteIP);
 }
 
 // Open teensyconfig.json and load the configuration
 void loadConfiguration(const char *filename, Config &config)
 {
-  // Open file for reading
+  unsigned long start = micros();
+
+  // Read the JSON once : its CRC tells if the binary image is still valid
   File file = SD.open(filename);
+  size_t size = file ? file.size() : 0;
+  char *json = (char *)malloc(size + 1);
+  size = file ? file.read(json, size) : 0;
+  json[size] = 0;
+  // Close the file (Curiously, File's destructor doesn't close the file)
+  file.close();
 
-  // Allocate a temporary JsonDocument
-  // Don't forget to change the capacity to match your requirements.
-  // Use arduinojson.org/v6/assistant to compute the capacity.
-  StaticJsonDocument<512> doc;
+  uint32_t sourceCrc = crc32(json, size);
+  // A new firmware may have changed the Config struct : its image is not trusted
+  const char build[] = __DATE__ " " __TIME__;
+  uint32_t buildId = crc32(build, sizeof(build));
+  if (size && readConfigCache(cachefilename, &config, sizeof(config), buildId, sourceCrc))
+  {
+    free(json);
+    applyConfiguration(config);
+    Serial.print("Configuration from cache, us: ");
+    Serial.println(micros() - start);
+    return;
+  }
+
+  // Allocate a temporary JsonDocument, sized from the file
+  DynamicJsonDocument doc(size * CONFIG_JSON_CAPACITY_RATIO + 256);
 
-  // Deserialize the JSON document
-  DeserializationError error = deserializeJson(doc, file);
+  // Deserialize the JSON document, in place
+  DeserializationError error = deserializeJson(doc, json, size);
   if (error)
     Serial.println(F("Failed to read file, using default configuration"));
 
@@ -616,13 +814,58 @@ void loadConfiguration(const char *filename, Config &config)
   }
   config.ledsperline = doc["ledsperline"];
   config.numberoflines = doc["numberoflines"];
-  config.ledsperstrip = config.ledsperline * config.numberoflines;
-  config.startuniverse = doc["startuniverse"];
-  config.numberofstrips = doc["numstrips"];
-  config.numberofleds = config.ledsperline * config.numberoflines * config.numberofstrips;
-  config.numberofchannels = config.numberofleds * 3;
-  config.numberofuniverses = config.numberofchannels / 512 + ((config.numberofchannels % 512) ? 1 : 0); // +1 si la division entire n'est pas égale a 0. 
-  config.maxuniverses = config.startuniverse + config.numberofuniverses;
+  // 15 bits Port-Address, or [net, subnet, universe] as shown by most consoles
+  if (doc["startuniverse"].is<JsonArray>())
+    config.startuniverse = ART_PORT_ADDRESS(doc["startuniverse"][0] | 0, doc["startuniverse"][1] | 0, doc["startuniverse"][2] | 0);
+  else
+    config.startuniverse = doc["startuniverse"] | 0;
+  config.startuniverse &= ART_PORT_ADDRESS_MASK;
+  config.numberofstrips = min((int)doc["numstrips"], PIXEL_MAX_STRIPS);
+  config.rgbw = doc["rgbw"] | false;
+  // "strips": [{"leds": 300, "order": "RGB", "ledsperline": 60, "serpentine": true}, ...]
+  // one entry per strip, missing ones get ledsperline * numberoflines leds in the order of config
+  for (int i = 0; i < PIXEL_MAX_STRIPS; i++)
+  {
+    config.stripleds[i] = doc["strips"][i]["leds"] | config.ledsperline * config.numberoflines;
+    // the white byte is decided by rgbw for all the strips, OctoWS2811 drives them the same way
+    config.striporder[i] = pixelOrderFromName(doc["strips"][i]["order"] | "", pixelOrder) & PIXEL_ORDER_MASK;
+    if (config.rgbw)
+      config.striporder[i] |= PIXEL_W;
+    config.stripledsperline[i] = doc["strips"][i]["ledsperline"] | config.ledsperline;
+    config.stripserpentine[i] = doc["strips"][i]["serpentine"] | false;
+  }
+  config.universealign = doc["universealign"] | true;
+  config.coalesce = doc["coalesce"] | true;
+  config.dither = doc["dither"] | false;
+  config.interpolate = doc["interpolate"] | false;
+  config.maxmilliamps = doc["maxmilliamps"] | 0;
+  config.channelmilliamps = doc["channelmilliamps"] | 20;
+  // sACN universes start at 1
+  config.sacn = doc["sacn"] | false;
+  snprintf(config.scenefile, sizeof(config.scenefile), "%s", doc["scenefile"] | "/scene.bin");
+  config.scenetimeout = doc["scenetimeout"] | 0;
+  snprintf(config.recordfile, sizeof(config.recordfile), "%s", doc["recordfile"] | "/record.bin");
+  config.recordmegabytes = doc["recordmegabytes"] | 256;
+  // "merge": "htp" or "ltp" when two consoles or servers send the same universes
+  const char *merge = doc["merge"] | "off";
+  if (!strcmp(merge, "htp"))
+    config.merge = MERGE_HTP;
+  else if (!strcmp(merge, "ltp"))
+    config.merge = MERGE_LTP;
+  else
+    config.merge = MERGE_OFF;
+  config.sacnstartuniverse = doc["sacnstartuniverse"] | (config.startuniverse > 0 ? config.startuniverse : 1);
+
+  // "gamma": 2.2 for the 3 colors or [2.2, 2.4, 2.6], "whitebalance": [255, 230, 210]
+  for (int i = 0; i < 3; i++)
+  {
+    if (doc["gamma"].is<JsonArray>())
+      config.gamma[i] = doc["gamma"][i] | 1.0f;
+    else
+      config.gamma[i] = doc["gamma"] | 1.0f;
+    config.whitebalance[i] = doc["whitebalance"][i] | 255;
+  }
+  applyConfiguration(config);
   /*
   int numberoflines;
   int numberofchannels;
@@ -633,8 +876,35 @@ void loadConfiguration(const char *filename, Config &config)
   int maxuniverses;
   */
 
-  // Close the file (Curiously, File's destructor doesn't close the file)
-  file.close();
+  // Next boot skips the parsing
+  if (!error && !writeConfigCache(cachefilename, &config, sizeof(config), buildId, sourceCrc))
+    Serial.println(F("Failed to write the configuration cache"));
+  free(json);
+  Serial.print("Configuration from JSON, us: ");
+  Serial.println(micros() - start);
+}
+
+// Tables derived from the configuration, built after a JSON or a cache load
+void applyConfiguration(Config &config)
+{
+  colorLut.build(config.gamma, config.whitebalance);
+  // OctoWS2811 gives every strip the same buffer, as long as the longest one
+  config.ledsperstrip = 0;
+  for (int i = 0; i < config.numberofstrips; i++)
+    config.ledsperstrip = max(config.ledsperstrip, config.stripleds[i]);
+  config.outputleds = config.ledsperstrip * config.numberofstrips;
+  config.channelsperpixel = config.rgbw ? 4 : 3;
+  pixelMap.begin(config.ledsperstrip);
+  for (int i = 0; i < config.numberofstrips; i++)
+    pixelMap.addStrip(config.stripleds[i], config.striporder[i], config.stripledsperline[i], config.stripserpentine[i]);
+  config.numberofleds = pixelMap.getNumberOfPixels();
+  config.numberofchannels = config.numberofleds * config.channelsperpixel;
+  // Per universe start pixel / pixel count / channel offset, the number of universes comes with it
+  universeMap.begin(config.numberofleds, config.channelsperpixel, config.universealign);
+  config.numberofuniverses = universeMap.getNumberOfUniverses();
+  config.maxuniverses = config.startuniverse + config.numberofuniverses;
+  if (config.maxuniverses > ART_PORT_ADDRESS_MASK + 1)
+    Serial.println(F("Universes past 32767 (net 127, subnet 15, universe 15) can not be received"));
 }
 
 // Serial print the configuration
@@ -674,7 +944,40 @@ void printConfiguration()
   Serial.print("Leds per line: ");
   Serial.println(configlist.ledsperline);
   Serial.print("startUniverse: ");
-  Serial.println(configlist.startuniverse);
+  Serial.print(configlist.startuniverse);
+  Serial.print(" (net ");
+  Serial.print(ART_NET_OF(configlist.startuniverse));
+  Serial.print(" subnet ");
+  Serial.print(ART_SUBNET_OF(configlist.startuniverse));
+  Serial.print(" universe ");
+  Serial.print(ART_UNIVERSE_OF(configlist.startuniverse));
+  Serial.println(")");
+  Serial.print("max mA per strip: ");
+  Serial.println(configlist.maxmilliamps);
+  Serial.print("interpolate: ");
+  Serial.println(configlist.interpolate);
+  Serial.print("dither: ");
+  Serial.println(configlist.dither);
+  Serial.print("coalesce: ");
+  Serial.println(configlist.coalesce);
+  Serial.print("scene: ");
+  Serial.print(configlist.scenefile);
+  Serial.print(" after ms: ");
+  Serial.println(configlist.scenetimeout);
+  Serial.print("record: ");
+  Serial.print(configlist.recordfile);
+  Serial.print(" MB: ");
+  Serial.println(configlist.recordmegabytes);
+  Serial.print("merge: ");
+  Serial.println(configlist.merge == MERGE_HTP ? "htp" : configlist.merge == MERGE_LTP ? "ltp" : "off");
+  Serial.print("sacn: ");
+  Serial.print(configlist.sacn);
+  Serial.print(" start universe: ");
+  Serial.println(configlist.sacnstartuniverse);
+  Serial.print("rgbw: ");
+  Serial.println(configlist.rgbw);
+  Serial.print("universe align: ");
+  Serial.println(configlist.universealign);
   Serial.print("num of universe: ");
   Serial.println(configlist.numberofuniverses);
   Serial.print("num of leds: ");
@@ -683,6 +986,189 @@ void printConfiguration()
   Serial.println(configlist.numberofchannels);
   Serial.print("num of strips: ");
   Serial.println(configlist.numberofstrips);
+  for (int i = 0; i < configlist.numberofstrips; i++)
+  {
+    Serial.print("  strip ");
+    Serial.print(i);
+    Serial.print(": leds ");
+    Serial.print(configlist.stripleds[i]);
+    Serial.print(" order ");
+    Serial.print(configlist.striporder[i]);
+    Serial.print(" leds per line ");
+    Serial.print(configlist.stripledsperline[i]);
+    Serial.print(" serpentine ");
+    Serial.println(configlist.stripserpentine[i]);
+  }
   Serial.print("num of lines: ");
   Serial.println(configlist.numberoflines);
-}
\ No newline at end of file
+}
+
+// Play the scene from the SD card while no DMX comes in
+void updatePlayback()
+{
+  bool lost = millis() - lastMsgTime > (unsigned long)configlist.scenetimeout;
+  if (lost && !player.isPlaying())
+  {
+    Serial.println("No DMX, playing the scene");
+    pipeline.resetFrame();
+    player.start(micros());
+  }
+  else if (!lost && player.isPlaying())
+  {
+    Serial.println("DMX is back, scene stopped");
+    player.stop();
+    pipeline.resetFrame();
+  }
+
+  if (!player.update(micros()))
+    return;
+
+  // Same copy as the network : color order, gamma, mapping and power budget apply
+  const SceneRecord *record = player.getRecord();
+  for (int i = 0; i < configlist.numberofuniverses; i++)
+  {
+    if (record->length[i])
+      pipeline.blitUniverse(i, player.getUniverse(i), record->length[i]);
+  }
+  pipeline.requestShow();
+}
+
+// Start or stop recording the incoming universes to configlist.recordfile
+void toggleRecording()
+{
+  if (recorder.isRecording())
+  {
+    recorder.stop();
+    Serial.print("Recording stopped, frames: ");
+    Serial.print(recorder.getFrames());
+    Serial.print(" dropped: ");
+    Serial.println(recorder.getDropped());
+    return;
+  }
+
+  if (recorder.start(configlist.recordfile, configlist.numberofuniverses, (uint64_t)configlist.recordmegabytes << 20))
+  {
+    Serial.print("Recording to ");
+    Serial.println(configlist.recordfile);
+  }
+  else
+  {
+    Serial.println("Recording failed");
+  }
+}
+
+// Serial print the runtime counters
+void printCounters()
+{
+  Serial.println("Counters:");
+  Serial.print("ArtDmx: ");
+  Serial.print(perf.artDmx);
+  Serial.print(" (");
+  Serial.print(perf.dmxPerSecond);
+  Serial.println("/s)");
+  Serial.print("ArtPoll: ");
+  Serial.println(perf.artPoll);
+  Serial.print("ArtSync: ");
+  Serial.print(perf.artSync);
+  if (configlist.issync)
+  {
+    Serial.print(pipeline.isSyncActive() ? " (sync mode)" : " (free-run)");
+    Serial.print(" timeouts: ");
+    Serial.print(perf.syncTimeouts);
+  }
+  Serial.println();
+  Serial.print("Rejected: ");
+  Serial.println(artnet.getRejectedPackets());
+  if (configlist.sacn)
+  {
+    Serial.print("sACN data / sync: ");
+    Serial.print(perf.sacnDmx);
+    Serial.print(" / ");
+    Serial.print(perf.sacnSync);
+    Serial.print(" rejected: ");
+    Serial.print(e131.getRejectedPackets());
+    Serial.print(" low priority: ");
+    Serial.print(e131.getLowPriorityPackets());
+    Serial.print(" lost / late: ");
+    Serial.print(e131.getSequences().getLost());
+    Serial.print(" / ");
+    Serial.println(e131.getSequences().getDropped());
+  }
+  Serial.print("Lost / late: ");
+  Serial.print(sequences.getLost());
+  Serial.print(" / ");
+  Serial.println(sequences.getDropped());
+  if (configlist.merge != MERGE_OFF)
+  {
+    Serial.print("Third sender packets ignored: ");
+    Serial.println(merger.getRejected());
+  }
+  Serial.print("Frames: ");
+  Serial.print(perf.frames);
+  Serial.print(" (");
+  Serial.print(perf.framesPerSecond);
+  Serial.print(configlist.dither || configlist.interpolate ? "/s refresh rate) skipped: " : "/s) skipped: ");
+  Serial.print(perf.skipped);
+  Serial.print(" power limited: ");
+  Serial.println(perf.limited);
+  if (configlist.interpolate)
+  {
+    Serial.print("Network frame interval us: ");
+    Serial.println(interpolator.getInterval());
+  }
+  if (power.isEnabled())
+  {
+    Serial.print("Strips mA:");
+    for (int i = 0; i < configlist.numberofstrips; i++)
+    {
+      Serial.print(" ");
+      Serial.print(power.getStripMilliamps(i));
+    }
+    Serial.println();
+  }
+  Serial.print("Show us min/avg/max: ");
+  Serial.print(perf.showCount ? perf.showMin : 0);
+  Serial.print(" / ");
+  Serial.print(perf.getShowAverage());
+  Serial.print(" / ");
+  Serial.println(perf.showMax);
+  Serial.print("Callbacks ms: ");
+  Serial.println((unsigned long)(perf.callbackTotal / 1000));
+  Serial.print("Loops/s: ");
+  Serial.println(perf.loopsPerSecond);
+}
+
+// Summary of the counters in the ArtPollReply, "#xxxx [yyyy] text" as in the Art-Net spec
+void updateNodeReport()
+{
+  char report[64];
+  snprintf(report, sizeof(report), "#0001 [%04lu] %lufps %ludmx/s show%luus lost%lu",
+           (unsigned long)(perf.artPoll % 10000), (unsigned long)perf.framesPerSecond,
+           (unsigned long)perf.dmxPerSecond, (unsigned long)perf.showMax,
+           (unsigned long)sequences.getLost());
+  artnet.setNodeReport(report);
+}
+
+// One letter commands on the serial port
+void readSerialCommand()
+{
+  switch (Serial.read())
+  {
+  case 'c':
+    printCounters();
+    break;
+  case 'r':
+    perf.reset();
+    sequences.resetCounters();
+    e131.getSequences().resetCounters();
+    merger.resetCounters();
+    Serial.println("Counters reset");
+    break;
+  case 'w':
+    toggleRecording();
+    break;
+  case 'b':
+    boot.print();
+    break;
+  }
+}
@@ -0,0 +1,353 @@
+/*
+ * @brief Art-Net load generator and conformance tester (Linux)
+ *
+ * @details Build with "pio run -e loadgen" then run
+ *   .pio/build/loadgen/program --node 192.168.0.10 --start 7 --universes 16 --fps 44 [--sync] [--poll 1000] [--duration 10]
+ * Sends --universes ArtDmx from --start (the startuniverse of the node) at
+ * --fps frames per second, 0 for as fast as the socket takes them, each
+ * frame followed by an ArtSync with --sync. Every --poll ms an ArtPoll is
+ * sent between two frames. Every second the achieved send rate is printed
+ * with the statistics the node puts in its ArtPollReply node report
+ * (fps, dmx/s, show time, lost packets), and the poll replies are checked :
+ * header, port, IP, and that every universe sent is announced.
+ * Replies come to port 6454 : to test the host build on the same machine,
+ * give it --broadcast 127.0.0.2 and this tool --bind 127.0.0.2.
+ *
+ */
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <time.h>
+#include "../ArtnetGithub.h"
+#include "../host/PosixUdpTransport.h"
+
+#define LOAD_MAX_UNIVERSES 1024
+#define LOAD_DMX_LENGTH 512
+// Art-Net 4 : an ArtPollReply is at least 207 bytes, older nodes send less of the filler
+#define LOAD_POLL_REPLY_MIN 207
+
+static PosixUdpTransport transport;
+static uint8_t packet[ART_DMX_START + LOAD_DMX_LENGTH];
+
+// Sent during the current report period
+static unsigned long sentFrames = 0;
+static unsigned long sentPackets = 0;
+static unsigned long sentBytes = 0;
+static unsigned long sendErrors = 0;
+static unsigned long lateFrames = 0;
+
+// Poll replies of the current poll round, and the result of the previous one
+static unsigned long replies = 0;
+static unsigned long badReplies = 0;
+static bool announced[ART_PORT_ADDRESS_MASK + 1];
+static char nodeReport[65];
+static bool roundDone = false;
+static unsigned long lastReplies = 0;
+static int lastMissing = 0;
+
+static IPAddress parseIP(const char *s)
+{
+  struct in_addr addr;
+  if (inet_pton(AF_INET, s, &addr) != 1)
+  {
+    fprintf(stderr, "invalid address %s\n", s);
+    exit(1);
+  }
+  uint32_t raw;
+  memcpy(&raw, &addr.s_addr, 4);
+  return IPAddress(raw);
+}
+
+static uint64_t nowNanos()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleepUntil(uint64_t deadline)
+{
+  struct timespec ts;
+  ts.tv_sec = deadline / 1000000000ULL;
+  ts.tv_nsec = deadline % 1000000000ULL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    ;
+}
+
+static void sendPacket(IPAddress node, const uint8_t *data, int size)
+{
+  transport.beginPacket(node, ART_NET_PORT);
+  transport.write(data, size);
+  if (transport.endPacket())
+  {
+    sentPackets++;
+    sentBytes += size;
+  }
+  else
+  {
+    // ENOBUFS : the interface queue is full, the rate is above what the link takes
+    sendErrors++;
+  }
+}
+
+// Art-Net header : ID, opcode (little endian), protocol version 14 (big endian)
+static int writeHeader(uint8_t *p, uint16_t opcode)
+{
+  memcpy(p, ART_NET_ID, 8);
+  p[8] = opcode & 0xFF;
+  p[9] = opcode >> 8;
+  p[10] = 0;
+  p[11] = 14;
+  return 12;
+}
+
+static void sendDmx(IPAddress node, uint16_t universe, uint8_t sequence, int length, unsigned long frame)
+{
+  writeHeader(packet, ART_DMX);
+  packet[12] = sequence;
+  packet[13] = 0; // physical
+  packet[14] = universe & 0xFF;
+  packet[15] = universe >> 8;
+  packet[16] = length >> 8;
+  packet[17] = length & 0xFF;
+  // A ramp moving every frame : each frame differs from the previous one
+  uint8_t *data = packet + ART_DMX_START;
+  for (int i = 0; i < length; i++)
+    data[i] = (uint8_t)(frame + universe + i);
+  sendPacket(node, packet, ART_DMX_START + length);
+}
+
+static void sendSync(IPAddress node)
+{
+  uint8_t sync[14];
+  writeHeader(sync, ART_SYNC);
+  sync[12] = 0; // aux
+  sync[13] = 0;
+  sendPacket(node, sync, sizeof(sync));
+}
+
+static void sendPoll(IPAddress node)
+{
+  uint8_t poll[14];
+  writeHeader(poll, ART_POLL);
+  poll[12] = 0; // flags : reply to this poll only
+  poll[13] = 0; // diagnostics priority
+  sendPacket(node, poll, sizeof(poll));
+}
+
+// Check one ArtPollReply and note the universes it announces
+static void readPollReply(const uint8_t *data, int size, IPAddress from)
+{
+  if (size < LOAD_POLL_REPLY_MIN)
+  {
+    printf("poll reply from %d.%d.%d.%d: %d bytes, at least %d expected\n", from[0], from[1], from[2], from[3], size, LOAD_POLL_REPLY_MIN);
+    badReplies++;
+    return;
+  }
+
+  struct artnet_reply_s reply;
+  memset(&reply, 0, sizeof(reply));
+  memcpy(&reply, data, min(size, (int)sizeof(reply)));
+  replies++;
+
+  if (IPAddress(reply.ip) != from)
+  {
+    printf("poll reply from %d.%d.%d.%d announces ip %d.%d.%d.%d\n", from[0], from[1], from[2], from[3], reply.ip[0], reply.ip[1], reply.ip[2], reply.ip[3]);
+    badReplies++;
+  }
+  if (reply.port != ART_NET_PORT)
+  {
+    printf("poll reply from %d.%d.%d.%d announces port %u\n", from[0], from[1], from[2], from[3], reply.port);
+    badReplies++;
+  }
+  if (reply.numbports > 4)
+  {
+    printf("poll reply from %d.%d.%d.%d announces %d ports, 4 max\n", from[0], from[1], from[2], from[3], reply.numbports);
+    badReplies++;
+    return;
+  }
+
+  for (int i = 0; i < reply.numbports; i++)
+    announced[ART_PORT_ADDRESS(reply.subH, reply.sub, reply.swout[i])] = true;
+  memcpy(nodeReport, reply.nodereport, 64);
+  nodeReport[64] = 0;
+}
+
+static void readReplies()
+{
+  uint8_t buffer[MAX_BUFFER_ARTNET];
+  while (transport.parsePacket())
+  {
+    IPAddress from = transport.remoteIP();
+    int size = transport.read(buffer, sizeof(buffer));
+    if (size < 10 || memcmp(buffer, ART_NET_ID, 8) != 0)
+      continue;
+    uint16_t opcode = buffer[8] | (buffer[9] << 8);
+    if (opcode == ART_POLL_REPLY)
+      readPollReply(buffer, size, from);
+  }
+}
+
+// Universes sent but not announced by the replies of the last poll round
+static int countMissing(int start, int count)
+{
+  int missing = 0;
+  for (int u = start; u < start + count; u++)
+  {
+    if (!announced[u & ART_PORT_ADDRESS_MASK])
+      missing++;
+  }
+  return missing;
+}
+
+int main(int argc, char **argv)
+{
+  IPAddress node(255, 255, 255, 255);
+  int startUniverse = 0;
+  int numberOfUniverses = 4;
+  float fps = 44.0f;
+  bool sync = false;
+  int pollMs = 1000;
+  int duration = 0;
+  int length = LOAD_DMX_LENGTH;
+  bool sequence = true;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--node") && i + 1 < argc)
+      node = parseIP(argv[++i]);
+    else if (!strcmp(argv[i], "--start") && i + 1 < argc)
+      startUniverse = atoi(argv[++i]) & ART_PORT_ADDRESS_MASK;
+    else if (!strcmp(argv[i], "--universes") && i + 1 < argc)
+      numberOfUniverses = min(atoi(argv[++i]), LOAD_MAX_UNIVERSES);
+    else if (!strcmp(argv[i], "--fps") && i + 1 < argc)
+      fps = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--sync"))
+      sync = true;
+    else if (!strcmp(argv[i], "--poll") && i + 1 < argc)
+      pollMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--duration") && i + 1 < argc)
+      duration = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--length") && i + 1 < argc)
+      length = min(max(atoi(argv[++i]) & ~1, 2), LOAD_DMX_LENGTH); // ArtDmx length is even
+    else if (!strcmp(argv[i], "--nosequence"))
+      sequence = false;
+    else if (!strcmp(argv[i], "--bind") && i + 1 < argc)
+      transport.setBindIP(parseIP(argv[++i]));
+    else
+    {
+      fprintf(stderr, "usage: %s [--node A.B.C.D] [--start U] [--universes N] [--fps F] [--sync] [--poll MS]\n"
+                      "          [--duration S] [--length 2..512] [--nosequence] [--bind A.B.C.D]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  if (!transport.begin(ART_NET_PORT))
+    return 1;
+
+  printf("%d universes from %d (net %d subnet %d universe %d), %d channels, %.1f fps%s to %d.%d.%d.%d\n",
+         numberOfUniverses, startUniverse, ART_NET_OF(startUniverse), ART_SUBNET_OF(startUniverse), ART_UNIVERSE_OF(startUniverse),
+         length, fps, sync ? " + ArtSync" : "", node[0], node[1], node[2], node[3]);
+
+  uint8_t sequences[LOAD_MAX_UNIVERSES];
+  memset(sequences, 0, sizeof(sequences));
+  uint64_t period = fps > 0 ? (uint64_t)(1e9 / fps) : 0;
+  uint64_t start = nowNanos();
+  uint64_t nextFrame = start;
+  uint64_t nextPoll = start;
+  uint64_t nextReport = start + 1000000000ULL;
+  uint64_t lastReport = start;
+  unsigned long frame = 0;
+  unsigned long totalFrames = 0;
+  unsigned long totalErrors = 0;
+  unsigned long totalLate = 0;
+
+  for (;;)
+  {
+    uint64_t now = nowNanos();
+    if (duration && now - start >= (uint64_t)duration * 1000000000ULL)
+      break;
+
+    if (pollMs > 0 && now >= nextPoll)
+    {
+      // a new round : the universes are announced again by its replies
+      if (now > start)
+      {
+        lastReplies = replies;
+        lastMissing = countMissing(startUniverse, numberOfUniverses);
+        roundDone = true;
+      }
+      memset(announced, 0, sizeof(announced));
+      replies = 0;
+      sendPoll(node);
+      nextPoll = now + (uint64_t)pollMs * 1000000ULL;
+    }
+
+    for (int u = 0; u < numberOfUniverses; u++)
+    {
+      uint16_t universe = (startUniverse + u) & ART_PORT_ADDRESS_MASK;
+      // 1..255, 0 disables the check on the node
+      if (sequence)
+        sequences[u] = sequences[u] == 255 ? 1 : sequences[u] + 1;
+      sendDmx(node, universe, sequences[u], length, frame);
+    }
+    if (sync)
+      sendSync(node);
+    frame++;
+    sentFrames++;
+    readReplies();
+
+    now = nowNanos();
+    if (now >= nextReport)
+    {
+      float seconds = (now - lastReport) / 1e9f;
+      printf("sent %.1f fps  %.0f pkt/s  %.2f Mbit/s  errors %lu  late %lu", sentFrames / seconds, sentPackets / seconds,
+             sentBytes * 8 / seconds / 1e6, sendErrors, lateFrames);
+      if (roundDone)
+      {
+        printf("  | replies %lu bad %lu missing universes %d", lastReplies, badReplies, lastMissing);
+        // Firmware node report : "#0001 [count] Nfps Ndmx/s showNus lostN"
+        unsigned long nodeFps, nodeDmx, nodeShow, nodeLost;
+        if (sscanf(nodeReport, "#%*x [%*u] %lufps %ludmx/s show%luus lost%lu", &nodeFps, &nodeDmx, &nodeShow, &nodeLost) == 4)
+          printf("  | node %lu fps  %lu dmx/s  show %lu us  lost %lu", nodeFps, nodeDmx, nodeShow, nodeLost);
+        else if (nodeReport[0])
+          printf("  | node \"%s\"", nodeReport);
+      }
+      printf("\n");
+      fflush(stdout);
+      totalFrames += sentFrames;
+      totalErrors += sendErrors;
+      totalLate += lateFrames;
+      sentFrames = 0;
+      sentPackets = 0;
+      sentBytes = 0;
+      sendErrors = 0;
+      lateFrames = 0;
+      badReplies = 0;
+      lastReport = now;
+      nextReport = now + 1000000000ULL;
+    }
+
+    if (period == 0)
+      continue;
+    nextFrame += period;
+    if (now > nextFrame)
+    {
+      // behind by more than a frame : start again from now instead of bursting to catch up
+      lateFrames++;
+      nextFrame = now;
+      continue;
+    }
+    sleepUntil(nextFrame);
+  }
+
+  float seconds = (nowNanos() - start) / 1e9f;
+  totalFrames += sentFrames;
+  totalErrors += sendErrors;
+  totalLate += lateFrames;
+  printf("total %lu frames in %.1f s : %.1f fps, %.0f universes/s, %lu send errors, %lu late frames\n", totalFrames, seconds,
+         totalFrames / seconds, totalFrames * numberOfUniverses / seconds, totalErrors, totalLate);
+  return totalErrors || totalLate ? 2 : 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * @brief FramePipeline on the workstation : known universes in, known frame out
+ *
+ * @details pio test -e native
+ * 2 strips of 200 GRB leds, 170 pixels per universe : 3 universes. Pixel p
+ * of the frame gets red (p * 3) & 0xFF, green p >> 1 and blue seed.
+ *
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include "FramePipeline.h"
+#include "UniverseMap.h"
+#include "PixelMap.h"
+#include "PixelBlit.h"
+#include "ConfigCache.h"
+#include "FramePixelOutput.h"
+#include "Dither.h"
+
+#define TEST_STRIPS 2
+#define TEST_LEDS 200
+#define TEST_PIXELS (TEST_STRIPS * TEST_LEDS)
+
+static UniverseMap universeMap;
+static PixelMap pixelMap;
+static PowerLimiter power;
+static UniverseBlit blitter;
+static UniverseTracker universesReceived;
+static SequenceTracker sequences;
+static UniverseMerger merger;
+static ShowScheduler scheduler;
+static PerfCounters perf;
+static FramePixelOutput output;
+static uint8_t ingestMemory[TEST_PIXELS * 3];
+static FramePipeline pipeline;
+static Dither dither;
+static ColorLut colorLut;
+static const IPAddress sender(10, 0, 0, 1);
+
+// DMX levels of universe u, RGB
+static uint16_t fillUniverse(uint8_t *data, int u, uint8_t seed)
+{
+  int count = 0;
+  for (int p = u * 170; p < (u + 1) * 170 && p < TEST_PIXELS; p++, count++)
+  {
+    data[count * 3] = (p * 3) & 0xFF;
+    data[count * 3 + 1] = p >> 1;
+    data[count * 3 + 2] = seed;
+  }
+  return count * 3;
+}
+
+static void sendUniverse(int u, uint8_t sequence, uint8_t seed)
+{
+  uint8_t data[512];
+  uint16_t length = fillUniverse(data, u, seed);
+  pipeline.receive(u, sequence, data, length, sender);
+}
+
+// Every channel of universe u at level
+static void sendLevel(int u, uint8_t sequence, uint8_t level)
+{
+  uint8_t data[512];
+  uint16_t length = fillUniverse(data, u, 0);
+  memset(data, level, length);
+  pipeline.receive(u, sequence, data, length, sender);
+}
+
+// The whole frame, in the wire order of the strips
+static void expectedFrame(uint8_t *frame, uint8_t seed)
+{
+  for (int p = 0; p < TEST_PIXELS; p++)
+  {
+    frame[p * 3] = p >> 1;
+    frame[p * 3 + 1] = (p * 3) & 0xFF;
+    frame[p * 3 + 2] = seed;
+  }
+}
+
+void setUp(void)
+{
+  uint8_t orders[TEST_STRIPS] = {PIXEL_GRB, PIXEL_GRB};
+  pixelMap.begin(TEST_LEDS);
+  for (int s = 0; s < TEST_STRIPS; s++)
+    pixelMap.addStrip(TEST_LEDS, PIXEL_GRB, TEST_LEDS, false);
+  universeMap.begin(pixelMap.getNumberOfPixels(), 3, true);
+  int universes = universeMap.getNumberOfUniverses();
+  power.begin(universes, TEST_STRIPS, 0, 0);
+  blitter.begin(&universeMap, &pixelMap, &power);
+  universesReceived.begin(universes);
+  sequences.begin(universes * MERGE_SOURCES);
+  merger.begin(universes, MERGE_OFF);
+  output.setLayout(TEST_STRIPS, TEST_LEDS, orders);
+  output.begin();
+  memset(ingestMemory, 0, sizeof(ingestMemory));
+  perf.reset();
+  pipeline = FramePipeline();
+  pipeline.begin(&output, &scheduler, &blitter, &universesReceived, &sequences, &merger, &power, &perf,
+                 ingestMemory, sizeof(ingestMemory));
+  pipeline.setCoalesce(false);
+}
+
+void tearDown(void)
+{
+}
+
+void test_complete_frame_is_shown(void)
+{
+  TEST_ASSERT_EQUAL_INT(3, universeMap.getNumberOfUniverses());
+  TEST_ASSERT_EQUAL_UINT32(sizeof(ingestMemory), output.getSize());
+
+  sendUniverse(0, 1, 0x40);
+  sendUniverse(1, 1, 0x40);
+  TEST_ASSERT_EQUAL_UINT32(0, output.getFrames());
+  sendUniverse(2, 1, 0x40);
+  TEST_ASSERT_EQUAL_UINT32(1, output.getFrames());
+
+  uint8_t frame[TEST_PIXELS * 3];
+  expectedFrame(frame, 0x40);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, output.getDrawingMemory(), sizeof(frame));
+  TEST_ASSERT_EQUAL_HEX32(crc32(frame, sizeof(frame)), output.getLastCrc());
+}
+
+void test_late_packet_is_dropped(void)
+{
+  for (int u = 0; u < 3; u++)
+    sendUniverse(u, 10, 0x40);
+  TEST_ASSERT_EQUAL_UINT32(1, output.getFrames());
+
+  // universe 0 only comes late : it must not complete the next frame
+  sendUniverse(1, 11, 0x80);
+  sendUniverse(2, 11, 0x80);
+  sendUniverse(0, 9, 0xFF);
+  TEST_ASSERT_EQUAL_UINT32(1, output.getFrames());
+
+  sendUniverse(0, 11, 0x80);
+  TEST_ASSERT_EQUAL_UINT32(2, output.getFrames());
+  uint8_t frame[TEST_PIXELS * 3];
+  expectedFrame(frame, 0x80);
+  TEST_ASSERT_EQUAL_HEX32(crc32(frame, sizeof(frame)), output.getLastCrc());
+}
+
+void test_sync_mode_shows_on_sync(void)
+{
+  pipeline.setSyncMode(true);
+  pipeline.sync();
+  TEST_ASSERT_TRUE(pipeline.isSyncActive());
+  TEST_ASSERT_EQUAL_UINT32(1, output.getFrames());
+
+  // a complete frame waits for the next sync
+  for (int u = 0; u < 3; u++)
+    sendUniverse(u, 1, 0x20);
+  TEST_ASSERT_EQUAL_UINT32(1, output.getFrames());
+  pipeline.sync();
+  TEST_ASSERT_EQUAL_UINT32(2, output.getFrames());
+
+  uint8_t frame[TEST_PIXELS * 3];
+  expectedFrame(frame, 0x20);
+  TEST_ASSERT_EQUAL_HEX32(crc32(frame, sizeof(frame)), output.getLastCrc());
+}
+
+// The power budget counts the levels after gamma, as the dither shows them
+void test_dither_power_after_gamma(void)
+{
+  uint8_t orders[TEST_STRIPS] = {PIXEL_GRB, PIXEL_GRB};
+  const float gamma[3] = {2.2f, 2.2f, 2.2f};
+  const uint8_t white[3] = {255, 255, 255};
+  colorLut.build(gamma, white);
+  dither.begin(TEST_STRIPS, TEST_LEDS, orders);
+  // 200 leds at 128 : 6023 mA before gamma, about 2600 mA after
+  power.begin(universeMap.getNumberOfUniverses(), TEST_STRIPS, 4000, 20);
+  pipeline.setColorLut(&colorLut);
+  pipeline.setDither(&dither);
+
+  for (int u = 0; u < 3; u++)
+    sendLevel(u, 1, 128);
+  TEST_ASSERT_TRUE(dither.isReady());
+  TEST_ASSERT_EQUAL_UINT32(0, perf.limited);
+  TEST_ASSERT_TRUE(power.getStripMilliamps(0) < 4000);
+
+  // full white, 12000 mA : dimmed
+  for (int u = 0; u < 3; u++)
+    sendLevel(u, 2, 255);
+  TEST_ASSERT_EQUAL_UINT32(1, perf.limited);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_complete_frame_is_shown);
+  RUN_TEST(test_late_packet_is_dropped);
+  RUN_TEST(test_sync_mode_shows_on_sync);
+  RUN_TEST(test_dither_power_after_gamma);
+  return UNITY_END();
+}